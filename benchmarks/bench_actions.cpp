@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "platform_actions.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+namespace
+{
+
+/** Environment file written into tmpfs, to measure pcmd and not the disk */
+void BM_PerformActions(benchmark::State& state)
+{
+    platform_actions::Actions_t actions;
+    for (int i = 0; i < state.range(0); i++)
+    {
+        actions.variables.push_back("PCM_VARIABLE_" + std::to_string(i) +
+                                    "=/usr/share/nvidia-pcm/value");
+    }
+    auto file = "/dev/shm/pcm-bench-env-" + std::to_string(getpid());
+
+    for (auto _ : state)
+    {
+        bool fileCreated = false;
+        benchmark::DoNotOptimize(
+            actions.performActions("Bench", fileCreated, file));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(file.c_str());
+}
+BENCHMARK(BM_PerformActions)->ArgName("variables")->Arg(1)->Arg(10)->Arg(
+    100);
+
+} // namespace
@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace bench
+{
+
+/** @brief Number of operator new calls since the start of the process */
+uint64_t allocations();
+
+/** @brief Peak RSS of the process, in KiB */
+int64_t peakRssKb();
+
+/**
+ * @brief Reports the allocations per iteration and the peak RSS
+ *
+ * To be created right before the benchmark loop, the counters are set when
+ * it goes out of scope.
+ */
+class AllocationCounters
+{
+  public:
+    explicit AllocationCounters(benchmark::State& state) :
+        state(state), begin(allocations())
+    {}
+
+    ~AllocationCounters()
+    {
+        state.counters["allocs"] =
+            benchmark::Counter(static_cast<double>(allocations() - begin),
+                               benchmark::Counter::kAvgIterations);
+        state.counters["peak_rss_kb"] = static_cast<double>(peakRssKb());
+    }
+
+    AllocationCounters(const AllocationCounters&) = delete;
+    AllocationCounters& operator=(const AllocationCounters&) = delete;
+
+  private:
+    benchmark::State& state;
+    uint64_t begin;
+};
+
+} // namespace bench
@@ -0,0 +1,60 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "dbus_accessor.hpp"
+#include "dbus_backend.hpp"
+
+#include <string>
+
+namespace bench
+{
+
+/** In-memory inventory: objects FruManager objects with the same value */
+class MemoryBackend : public dbus::Backend
+{
+  public:
+    MemoryBackend(size_t objects, const std::string& value) : value(value)
+    {
+        dbus::DBusSubTree objectTree;
+        for (size_t i = 0; i < objects; i++)
+        {
+            objectTree["/xyz/openbmc_project/inventory/system/board/" +
+                       std::to_string(i)][dbus::service_name::fruManager] = {};
+        }
+        tree = std::make_shared<const dbus::DBusSubTree>(std::move(objectTree));
+    }
+
+    dbus::DBusSubTreePtr getSubTree(const std::string&) override
+    {
+        return tree;
+    }
+
+    void getProperty(const std::string&, const std::string&,
+                     const std::string&, const std::string&,
+                     dbus::DBusValue& result) override
+    {
+        result = value;
+    }
+
+  private:
+    dbus::DBusSubTreePtr tree;
+    std::string value;
+};
+
+} // namespace bench
@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bench_backend.hpp"
+#include "constants.hpp"
+#include "platform_checks.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+platform_checks::Checks_t makeCheck(const std::string& rule)
+{
+    platform_checks::Checks_t check;
+    check.rule = rule;
+    check.interface = "xyz.openbmc_project.Inventory.Decorator.Asset";
+    check.property = "Model";
+    check.value = "NVIDIA HGX H100 8-GPU";
+    return check;
+}
+
+/** All objects are read and compared, the worst case of a passing check */
+void BM_CheckMatchAll(benchmark::State& state)
+{
+    bench::MemoryBackend backend(state.range(0), "NVIDIA HGX H100 8-GPU");
+    auto check = makeCheck(constants::MATCH_ALL);
+    for (auto _ : state)
+    {
+        platform_checks::CheckResult result;
+        benchmark::DoNotOptimize(check.performChecks(backend, result));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CheckMatchAll)->ArgName("objects")->RangeMultiplier(10)->Range(
+    1, 1000);
+
+/** No object matches, every value is compared before failing */
+void BM_CheckMatchAnyMiss(benchmark::State& state)
+{
+    bench::MemoryBackend backend(state.range(0), "Unknown");
+    auto check = makeCheck(constants::MATCH_ONE);
+    for (auto _ : state)
+    {
+        platform_checks::CheckResult result;
+        benchmark::DoNotOptimize(check.performChecks(backend, result));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CheckMatchAnyMiss)
+    ->ArgName("objects")
+    ->RangeMultiplier(10)
+    ->Range(1, 1000);
+
+} // namespace
@@ -0,0 +1,56 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cmd_line.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+int ignore(cmd_line::ArgFuncParamType)
+{
+    return 0;
+}
+
+/** Options of a typical pcmd unit */
+void BM_CmdLineParse(benchmark::State& state)
+{
+    cmd_line::CmdLineArgs args = {
+        {"-d", "--data-dir", cmd_line::OptFlag::overwrite, "<directory>",
+         cmd_line::ActFlag::normal, "Data directory.", ignore},
+        {"-l", "--log-level", cmd_line::OptFlag::overwrite, "<level>",
+         cmd_line::ActFlag::normal, "Log level.", ignore},
+        {"-r", "--log-rotate", cmd_line::OptFlag::overwrite,
+         "<bytes> <count>", cmd_line::ActFlag::normal, "Rotation.", ignore},
+        {"-s", "--skip-checks", cmd_line::OptFlag::none, "",
+         cmd_line::ActFlag::normal, "Skip checks.", ignore},
+        {"-w", "--watch", cmd_line::OptFlag::none, "",
+         cmd_line::ActFlag::normal, "Watch.", ignore},
+    };
+    const char* argv[] = {"pcmd", "-d", "/usr/share/nvidia-pcm/", "-l", "2",
+                          "-r",   "1048576", "3", "-s", "-w"};
+    for (auto _ : state)
+    {
+        cmd_line::CmdLine cmdLine(std::size(argv), const_cast<char**>(argv),
+                                  args);
+        benchmark::DoNotOptimize(cmdLine.parse());
+    }
+}
+BENCHMARK(BM_CmdLineParse);
+
+} // namespace
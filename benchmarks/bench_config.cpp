@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bench_alloc.hpp"
+#include "platform_config.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace
+{
+
+/** Platform config with the given number of checks and objects per check */
+json makeConfig(int checks, int objects)
+{
+    json j;
+    j["Name"] = "Bench";
+    j["Rule"] = "matchall";
+    j["Checks"] = json::array();
+    for (int c = 0; c < checks; c++)
+    {
+        json check;
+        check["interface"] = "xyz.openbmc_project.Inventory.Decorator.Asset";
+        check["property"] = "Model";
+        check["value"] = "NVIDIA HGX H100 8-GPU " + std::to_string(c);
+        check["objects"] = json::array();
+        for (int o = 0; o < objects; o++)
+        {
+            check["objects"].push_back(
+                "/xyz/openbmc_project/inventory/system/board/" +
+                std::to_string(o));
+        }
+        j["Checks"].push_back(check);
+    }
+    json action;
+    action["variables"] = {"AML_DAT=/usr/share/oobaml/dat.json",
+                           "AML_EVENT_INFO=/usr/share/oobaml/event_info.json"};
+    j["Actions"] = json::array({action});
+    return j;
+}
+
+void BM_ConfigLoadFrom(benchmark::State& state)
+{
+    auto j = makeConfig(state.range(0), state.range(1));
+    bench::AllocationCounters counters(state);
+    for (auto _ : state)
+    {
+        platform_config::Config config;
+        config.loadFrom(j);
+        benchmark::DoNotOptimize(config);
+    }
+}
+BENCHMARK(BM_ConfigLoadFrom)
+    ->ArgNames({"checks", "objects"})
+    ->ArgsProduct({{1, 10, 100}, {0, 8, 64}});
+
+void BM_ConfigLoadFromFile(benchmark::State& state)
+{
+    auto file = "/tmp/pcm-bench-config-" + std::to_string(getpid()) +
+                ".json";
+    std::ofstream(file) << makeConfig(state.range(0), state.range(1)).dump(4);
+    {
+        bench::AllocationCounters counters(state);
+        for (auto _ : state)
+        {
+            platform_config::Config config;
+            benchmark::DoNotOptimize(config.loadFromFile(file));
+        }
+    }
+    std::remove(file.c_str());
+}
+BENCHMARK(BM_ConfigLoadFromFile)
+    ->ArgNames({"checks", "objects"})
+    ->ArgsProduct({{1, 10, 100}, {0, 8, 64}});
+
+} // namespace
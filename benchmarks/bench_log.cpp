@@ -0,0 +1,74 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "log.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+
+namespace
+{
+
+/** Distinct messages, identical ones would be collapsed as repeated */
+std::atomic<uint64_t> sequence{0};
+
+void setUp(const benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+    {
+        log_set_file("/dev/null");
+        log_set_level(state.range(0));
+    }
+}
+
+void tearDown(const benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+    {
+        log_flush();
+        log_set_level(LogLevel::disabled);
+        log_set_file("");
+    }
+}
+
+/**
+ * A debug message with the log level at range(0): 1 measures the cost of a
+ * filtered call, 3 a formatted and written one.
+ */
+void BM_LogDebug(benchmark::State& state)
+{
+    setUp(state);
+    for (auto _ : state)
+    {
+        logs_dbg("Get %s %s %lu\n", "xyz.openbmc_project.FruManager",
+                 "/xyz/openbmc_project/inventory/system/board/0",
+                 sequence.fetch_add(1, std::memory_order_relaxed));
+    }
+    state.SetItemsProcessed(state.iterations());
+    tearDown(state);
+}
+BENCHMARK(BM_LogDebug)
+    ->ArgName("level")
+    ->Arg(LogLevel::error)
+    ->Arg(LogLevel::debug)
+    ->Threads(1)
+    ->Threads(4)
+    ->Threads(8)
+    ->UseRealTime();
+
+} // namespace
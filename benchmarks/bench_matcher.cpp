@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bench_alloc.hpp"
+#include "bench_backend.hpp"
+#include "constants.hpp"
+#include "platform_matcher.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr auto matchingValue = "NVIDIA HGX H100 8-GPU";
+
+/**
+ * Data directory with the given number of configs of 8 checks searching the
+ * mapper. The last config matches, the others fail on their last check.
+ */
+class DataDir
+{
+  public:
+    explicit DataDir(int configs) :
+        path("/tmp/pcm-bench-data-" + std::to_string(getpid()) + "/")
+    {
+        fs::create_directories(path + "platform-configuration-files");
+        for (int k = 0; k < configs; k++)
+        {
+            write("platform-configuration-files/bench_" + std::to_string(k) +
+                      ".json",
+                  makeConfig("Bench " + std::to_string(k), k == configs - 1));
+        }
+        write(constants::DEFAULT_CONF_FILE_NAME, makeConfig("Default", true));
+    }
+
+    ~DataDir()
+    {
+        fs::remove_all(path);
+    }
+
+    const std::string path;
+
+  private:
+    static json makeConfig(const std::string& name, bool matching)
+    {
+        json j;
+        j["Name"] = name;
+        j["Checks"] = json::array();
+        for (int c = 0; c < 8; c++)
+        {
+            json check;
+            check["rule"] = "MatchAll";
+            check["objects"] = json::array();
+            check["interface"] = "com.Nvidia.Bench.Interface" +
+                                 std::to_string(c);
+            check["property"] = "Value";
+            check["value"] = (matching || c < 7) ? matchingValue : "Other";
+            j["Checks"].push_back(check);
+        }
+        json action;
+        action["variables"] = {"PCM_BENCH_CONFIG=" + name};
+        j["Actions"] = json::array({action});
+        return j;
+    }
+
+    void write(const std::string& file, const json& j)
+    {
+        std::ofstream(path + file) << j.dump(4);
+    }
+};
+
+/** Loading of every config of a data directory, as at boot and on reload */
+void BM_MatcherLoad(benchmark::State& state)
+{
+    DataDir data(state.range(0));
+    bench::AllocationCounters counters(state);
+    for (auto _ : state)
+    {
+        platform_matcher::PlatformMatcher matcher(data.path);
+        benchmark::DoNotOptimize(&matcher);
+    }
+}
+BENCHMARK(BM_MatcherLoad)->ArgName("configs")->Arg(1)->Arg(8)->Arg(64);
+
+/** One evaluation, the per-evaluation cache answers the repeated requests */
+void BM_MatcherEvaluate(benchmark::State& state)
+{
+    DataDir data(state.range(0));
+    platform_matcher::PlatformMatcher matcher(data.path);
+    bench::MemoryBackend backend(state.range(1), matchingValue);
+    bench::AllocationCounters counters(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(matcher.evaluate(backend));
+    }
+}
+BENCHMARK(BM_MatcherEvaluate)
+    ->ArgNames({"configs", "objects"})
+    ->ArgsProduct({{1, 8, 64}, {8, 64}});
+
+} // namespace
@@ -0,0 +1,329 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * pcm-inventory-stub - object mapper and inventory stand-in for pcm_scale.sh
+ *
+ *   pcm-inventory-stub <inventory.json> <stats.json>
+ *
+ * Serves the objects of an inventory written by pcm_scale_gen.py on the
+ * default bus, under the object mapper and FruManager service names, so that
+ * pcmd runs unmodified on a private bus. Each interface of an object has one
+ * string property, "Value". The number of calls answered is written to the
+ * stats file on SIGTERM or SIGINT.
+ */
+
+#include "dbus_accessor.hpp"
+#include "dbus_types.hpp"
+
+#include <nlohmann/json.hpp>
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace
+{
+
+constexpr auto invalidArgs = "org.freedesktop.DBus.Error.InvalidArgs";
+constexpr auto notFound = "xyz.openbmc_project.Common.Error.ResourceNotFound";
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+struct Inventory
+{
+    /** @brief Value of each interface of each object */
+    std::map<dbus::DBusPath, std::map<dbus::DBusInterface, std::string>>
+        objects;
+
+    uint64_t getSubTreeCalls = 0;
+    uint64_t getSubTreePathsCalls = 0;
+    uint64_t getObjectCalls = 0;
+    uint64_t getCalls = 0;
+
+    /** @brief Objects under path implementing any of interfaces, or all of
+     * them if interfaces is empty */
+    dbus::DBusSubTree subTree(const std::string& path,
+                              const dbus::DBusInterfaceList& interfaces) const
+    {
+        dbus::DBusSubTree result;
+        auto prefix = (path == "/") ? path : path + "/";
+        for (const auto& [objectPath, values] : objects)
+        {
+            if (objectPath != path && objectPath.rfind(prefix, 0) != 0)
+            {
+                continue;
+            }
+            dbus::DBusInterfaceList found;
+            for (const auto& [interface, value] : values)
+            {
+                if (interfaces.empty() ||
+                    std::find(interfaces.begin(), interfaces.end(),
+                              interface) != interfaces.end())
+                {
+                    found.push_back(interface);
+                }
+            }
+            if (!found.empty())
+            {
+                result[objectPath][dbus::service_name::fruManager] =
+                    std::move(found);
+            }
+        }
+        return result;
+    }
+};
+
+int getSubTree(sd_bus_message* msg, void* context, sd_bus_error* error)
+{
+    auto* inventory = static_cast<Inventory*>(context);
+    try
+    {
+        auto m = sdbusplus::message::message(msg);
+        std::string path;
+        int32_t depth = 0;
+        dbus::DBusInterfaceList interfaces;
+        m.read(path, depth, interfaces);
+        inventory->getSubTreeCalls++;
+
+        auto reply = m.new_method_return();
+        reply.append(inventory->subTree(path, interfaces));
+        reply.method_return();
+    }
+    catch (const std::exception& e)
+    {
+        return sd_bus_error_set_const(error, invalidArgs, e.what());
+    }
+    return 1;
+}
+
+int getSubTreePaths(sd_bus_message* msg, void* context, sd_bus_error* error)
+{
+    auto* inventory = static_cast<Inventory*>(context);
+    try
+    {
+        auto m = sdbusplus::message::message(msg);
+        std::string path;
+        int32_t depth = 0;
+        dbus::DBusInterfaceList interfaces;
+        m.read(path, depth, interfaces);
+        inventory->getSubTreePathsCalls++;
+
+        dbus::DBusPathList paths;
+        for (auto& [objectPath, services] :
+             inventory->subTree(path, interfaces))
+        {
+            paths.push_back(objectPath);
+        }
+        auto reply = m.new_method_return();
+        reply.append(paths);
+        reply.method_return();
+    }
+    catch (const std::exception& e)
+    {
+        return sd_bus_error_set_const(error, invalidArgs, e.what());
+    }
+    return 1;
+}
+
+int getObject(sd_bus_message* msg, void* context, sd_bus_error* error)
+{
+    auto* inventory = static_cast<Inventory*>(context);
+    try
+    {
+        auto m = sdbusplus::message::message(msg);
+        std::string path;
+        dbus::DBusInterfaceList interfaces;
+        m.read(path, interfaces);
+        inventory->getObjectCalls++;
+
+        auto tree = inventory->subTree(path, interfaces);
+        auto it = tree.find(path);
+        if (it == tree.end())
+        {
+            return sd_bus_error_set_const(error, notFound, path.c_str());
+        }
+        auto reply = m.new_method_return();
+        reply.append(it->second);
+        reply.method_return();
+    }
+    catch (const std::exception& e)
+    {
+        return sd_bus_error_set_const(error, invalidArgs, e.what());
+    }
+    return 1;
+}
+
+/** Context of the Value property of one interface of one object */
+struct Value
+{
+    Inventory* inventory;
+    const std::string* value;
+};
+
+int getValue(sd_bus*, const char*, const char*, const char*,
+             sd_bus_message* reply, void* context, sd_bus_error* error)
+{
+    auto* property = static_cast<Value*>(context);
+    try
+    {
+        auto m = sdbusplus::message::message(reply);
+        m.append(*property->value);
+        property->inventory->getCalls++;
+    }
+    catch (const std::exception& e)
+    {
+        return sd_bus_error_set_const(error, invalidArgs, e.what());
+    }
+    return 1;
+}
+
+const sdbusplus::vtable::vtable_t mapperVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method("GetSubTree", "sias", "a{sa{sas}}", getSubTree),
+    sdbusplus::vtable::method("GetSubTreePaths", "sias", "as",
+                              getSubTreePaths),
+    sdbusplus::vtable::method("GetObject", "sas", "a{sas}", getObject),
+    sdbusplus::vtable::end()};
+
+const sdbusplus::vtable::vtable_t valueVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property("Value", "s", getValue,
+                                sdbusplus::vtable::property_::const_),
+    sdbusplus::vtable::end()};
+
+void writeStats(const Inventory& inventory, const std::string& file)
+{
+    json stats;
+    stats["objects"] = inventory.objects.size();
+    stats["get_sub_tree"] = inventory.getSubTreeCalls;
+    stats["get_sub_tree_paths"] = inventory.getSubTreePathsCalls;
+    stats["get_object"] = inventory.getObjectCalls;
+    stats["get"] = inventory.getCalls;
+    stats["calls"] = inventory.getSubTreeCalls +
+                     inventory.getSubTreePathsCalls +
+                     inventory.getObjectCalls + inventory.getCalls;
+    std::ofstream(file) << stats.dump(4) << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <inventory.json> <stats.json>"
+                  << std::endl;
+        return 1;
+    }
+
+    Inventory inventory;
+    try
+    {
+        std::ifstream file(argv[1]);
+        auto data = json::parse(file);
+        for (const auto& [path, interfaces] : data["objects"].items())
+        {
+            inventory.objects[path] =
+                interfaces.get<std::map<dbus::DBusInterface, std::string>>();
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Unable to load " << argv[1] << ": " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGTERM, requestStop);
+    std::signal(SIGINT, requestStop);
+
+    try
+    {
+        auto bus = sdbusplus::bus::new_default();
+
+        size_t count = 0;
+        for (const auto& [path, interfaces] : inventory.objects)
+        {
+            count += interfaces.size();
+        }
+
+        // Reserved, the property contexts must not move
+        std::vector<Value> values;
+        values.reserve(count);
+        std::vector<std::unique_ptr<sdbusplus::server::interface_t>> objects;
+        objects.reserve(count + 1);
+        for (const auto& [path, interfaces] : inventory.objects)
+        {
+            for (const auto& [interface, value] : interfaces)
+            {
+                values.push_back({&inventory, &value});
+                objects.push_back(
+                    std::make_unique<sdbusplus::server::interface_t>(
+                        bus, path.c_str(), interface.c_str(), valueVtable,
+                        &values.back()));
+            }
+        }
+        objects.push_back(std::make_unique<sdbusplus::server::interface_t>(
+            bus, dbus::object_path::objectMapper, dbus::interface::objectMapper,
+            mapperVtable, &inventory));
+
+        // The mapper name last, pcm_scale.sh waits for it
+        bus.request_name(dbus::service_name::fruManager);
+        bus.request_name(dbus::service_name::objectMapper);
+
+        while (!stopRequested)
+        {
+            while (bus.process_discard())
+            {}
+            try
+            {
+                bus.wait(std::chrono::milliseconds(100));
+            }
+            catch (const std::exception&)
+            {
+                // Interrupted by a signal, checked by the loop
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        writeStats(inventory, argv[2]);
+        return 1;
+    }
+
+    writeStats(inventory, argv[2]);
+    return 0;
+}
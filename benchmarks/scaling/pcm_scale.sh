@@ -0,0 +1,215 @@
+#!/bin/bash
+# SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES.
+# All rights reserved. SPDX-License-Identifier: Apache-2.0
+#
+# End-to-end scaling of pcmd on a private bus, no BMC needed.
+#
+# For every combination of objects (N), interfaces (M) and platform
+# configurations (K), generates an inventory with pcm_scale_gen.py, starts a
+# private dbus-daemon and pcm-inventory-stub on it, and runs pcmd against it.
+# Prints one CSV line per run:
+#   objects,interfaces,configs,overlap,run,wall_us,cpu_us,peak_rss_kb,
+#   dbus_calls,dbus_messages,winner
+# wall_us, cpu_us and peak_rss_kb come from the pcmd run report, dbus_calls
+# is the number of calls the stub answered, and dbus_messages the number of
+# messages pcmd sent or received on the bus, counted by dbus-monitor.
+
+set -euo pipefail
+
+usage()
+{
+    cat <<USAGE
+Usage: $0 [options] <pcmd> <pcm-inventory-stub>
+  -n "<list>"  objects, default "10 100 1000"
+  -m "<list>"  interfaces, default "1 4 16"
+  -k "<list>"  platform configurations, default "1 8 64"
+  -v <ratio>   checks shared with the matching configuration, default 0.5
+  -r <count>   runs of every combination, default 3
+  -o <file>    CSV output, default standard output
+USAGE
+    exit 1
+}
+
+objects="10 100 1000"
+interfaces="1 4 16"
+configs="1 8 64"
+overlap=0.5
+runs=3
+output=/dev/stdout
+
+while getopts "n:m:k:v:r:o:h" opt; do
+    case "${opt}" in
+        n) objects="${OPTARG}" ;;
+        m) interfaces="${OPTARG}" ;;
+        k) configs="${OPTARG}" ;;
+        v) overlap="${OPTARG}" ;;
+        r) runs="${OPTARG}" ;;
+        o) output="${OPTARG}" ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+[ $# -eq 2 ] || usage
+pcmd=$(realpath "$1")
+stub=$(realpath "$2")
+generator="$(dirname "$(realpath "$0")")/pcm_scale_gen.py"
+
+work=$(mktemp -d -t pcm-scale.XXXXXX)
+daemon_pid=""
+stub_pid=""
+monitor_pid=""
+
+stop()
+{
+    if [ -n "${monitor_pid}" ]; then
+        kill -TERM "${monitor_pid}" 2>/dev/null || true
+        wait "${monitor_pid}" 2>/dev/null || true
+        monitor_pid=""
+    fi
+    if [ -n "${stub_pid}" ]; then
+        kill -TERM "${stub_pid}" 2>/dev/null || true
+        wait "${stub_pid}" 2>/dev/null || true
+        stub_pid=""
+    fi
+    if [ -n "${daemon_pid}" ]; then
+        kill -TERM "${daemon_pid}" 2>/dev/null || true
+        wait "${daemon_pid}" 2>/dev/null || true
+        daemon_pid=""
+    fi
+}
+
+cleanup()
+{
+    stop
+    rm -rf "${work}"
+}
+trap cleanup EXIT
+
+# Waits until the private bus accepts connections
+wait_bus()
+{
+    for _ in $(seq 1 100); do
+        if [ -S "${work}/bus" ]; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    echo "Timed out waiting for dbus-daemon" >&2
+    return 1
+}
+
+# Waits until the given name is owned on the private bus
+wait_name()
+{
+    for _ in $(seq 1 600); do
+        if busctl --address="${DBUS_SYSTEM_BUS_ADDRESS}" list --acquired \
+            --no-legend 2>/dev/null | grep -q "^$1 "; then
+            return 0
+        fi
+        if ! kill -0 "${stub_pid}" 2>/dev/null; then
+            echo "pcm-inventory-stub exited" >&2
+            return 1
+        fi
+        sleep 0.1
+    done
+    echo "Timed out waiting for $1" >&2
+    return 1
+}
+
+# Starts dbus-monitor on the private bus, writing to $1, and waits until it
+# became a monitor
+start_monitor()
+{
+    dbus-monitor --address "${DBUS_SYSTEM_BUS_ADDRESS}" --profile >"$1" \
+        2>/dev/null &
+    monitor_pid=$!
+    for _ in $(seq 1 100); do
+        if grep -q "NameLost" "$1"; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    echo "Timed out waiting for dbus-monitor" >&2
+    return 1
+}
+
+# Prints wall_us,cpu_us,peak_rss_kb,dbus_calls,dbus_messages,winner
+results()
+{
+    python3 - "$@" <<'PYTHON'
+import json
+import sys
+
+report, stats, monitor, env = sys.argv[1:5]
+run = json.load(open(report))["run"]
+calls = json.load(open(stats))["calls"]
+
+# pcmd is the only client connecting once the monitor runs, its unique name
+# is the sender of the first Hello
+pcmd = None
+messages = 0
+for line in open(monitor):
+    fields = line.rstrip("\n").split("\t")
+    if line.startswith("#") or len(fields) < 5:
+        continue
+    if pcmd is None and fields[0] == "mc" and fields[-1] == "Hello":
+        pcmd = fields[3]
+    if pcmd is not None and pcmd in (fields[3], fields[4]):
+        messages += 1
+
+winner = ""
+for line in open(env):
+    if line.startswith("NAME="):
+        winner = line.strip()[len("NAME="):]
+print("%d,%d,%d,%d,%d,%s" % (run["wall_us"], run["cpu_us"],
+                             run["peak_rss_kb"], calls, messages, winner))
+PYTHON
+}
+
+# pcmd and the stub use the default bus, make it the private one
+export DBUS_STARTER_BUS_TYPE=system
+export DBUS_SYSTEM_BUS_ADDRESS="unix:path=${work}/bus"
+
+header="objects,interfaces,configs,overlap,run"
+header+=",wall_us,cpu_us,peak_rss_kb,dbus_calls,dbus_messages,winner"
+echo "${header}" >"${output}"
+
+for n in ${objects}; do
+    for m in ${interfaces}; do
+        for k in ${configs}; do
+            case_dir="${work}/${n}-${m}-${k}"
+            python3 "${generator}" -n "${n}" -m "${m}" -k "${k}" \
+                -v "${overlap}" "${case_dir}"
+            for run in $(seq 1 "${runs}"); do
+                rm -f "${work}/bus" "${case_dir}/env" \
+                    "${case_dir}/stats.json" "${case_dir}/monitor.tsv"
+                dbus-daemon --session --nofork --nopidfile \
+                    --address="${DBUS_SYSTEM_BUS_ADDRESS}" \
+                    2>>"${case_dir}/dbus-daemon.log" &
+                daemon_pid=$!
+                wait_bus
+                "${stub}" "${case_dir}/inventory.json" \
+                    "${case_dir}/stats.json" &
+                stub_pid=$!
+                wait_name xyz.openbmc_project.ObjectMapper
+                start_monitor "${case_dir}/monitor.tsv"
+
+                "${pcmd}" -d "${case_dir}/data/" -l 0 \
+                    -E "${case_dir}/env" -P "${case_dir}/report.json" \
+                    >"${case_dir}/pcmd.log" 2>&1 || {
+                    echo "pcmd failed, see below" >&2
+                    cat "${case_dir}/pcmd.log" >&2
+                    exit 1
+                }
+                # Lets the monitor print the last messages of pcmd
+                sleep 0.2
+                stop
+
+                echo "${n},${m},${k},${overlap},${run},$(results \
+                    "${case_dir}/report.json" "${case_dir}/stats.json" \
+                    "${case_dir}/monitor.tsv" "${case_dir}/env")" \
+                    >>"${output}"
+            done
+        done
+    done
+done
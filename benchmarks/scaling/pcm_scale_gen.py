@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES.
+# All rights reserved. SPDX-License-Identifier: Apache-2.0
+
+"""Synthetic inventory and platform configurations for pcm_scale.sh.
+
+Writes to the output directory:
+  inventory.json                          served by pcm-inventory-stub
+  data/platform-configuration-files/*.json
+  data/default_platform_configuration.json
+
+The inventory has N objects, each implementing the M interfaces
+com.Nvidia.Bench.Interface<m> with the property Value = "value-<m>".
+
+There are K platform configurations of C checks, the checks cover the
+interfaces in turn and search the objects through the mapper. The last
+configuration, "Bench <K-1>", matches. The others share the first
+round(overlap * C) checks with it and fail on the next one, so the overlap
+controls how much of the inventory the engine can reuse between them.
+"""
+
+import argparse
+import json
+import os
+
+
+def interface(m):
+    return "com.Nvidia.Bench.Interface%d" % m
+
+
+def check(m, value):
+    return {
+        "rule": "MatchAll",
+        "objects": [],
+        "interface": interface(m),
+        "property": "Value",
+        "value": value,
+    }
+
+
+def config(name, checks):
+    return {
+        "Name": name,
+        "Checks": checks,
+        "Actions": [
+            {
+                "type": "",
+                "variables": ["PCM_BENCH_CONFIG=" + name.replace(" ", "_")],
+            }
+        ],
+    }
+
+
+def write(path, data):
+    with open(path, "w") as f:
+        json.dump(data, f, indent=4)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-n", "--objects", type=int, default=100)
+    parser.add_argument("-m", "--interfaces", type=int, default=4)
+    parser.add_argument("-k", "--configs", type=int, default=8)
+    parser.add_argument(
+        "-c", "--checks", type=int, help="checks per config, default M"
+    )
+    parser.add_argument(
+        "-v",
+        "--overlap",
+        type=float,
+        default=0.5,
+        help="fraction of the checks shared with the matching config",
+    )
+    parser.add_argument("output")
+    args = parser.parse_args()
+
+    if args.objects < 1 or args.interfaces < 1 or args.configs < 1:
+        parser.error("objects, interfaces and configs must be at least 1")
+    if not 0.0 <= args.overlap <= 1.0:
+        parser.error("overlap must be between 0 and 1")
+    checks = args.checks or args.interfaces
+
+    data = os.path.join(args.output, "data")
+    configs = os.path.join(data, "platform-configuration-files")
+    os.makedirs(configs, exist_ok=True)
+
+    objects = {}
+    for n in range(args.objects):
+        path = "/xyz/openbmc_project/inventory/system/bench/object%d" % n
+        objects[path] = {
+            interface(m): "value-%d" % m for m in range(args.interfaces)
+        }
+    write(os.path.join(args.output, "inventory.json"), {"objects": objects})
+
+    matching = [
+        check(c % args.interfaces, "value-%d" % (c % args.interfaces))
+        for c in range(checks)
+    ]
+    shared = min(round(args.overlap * checks), checks - 1)
+    for k in range(args.configs):
+        if k == args.configs - 1:
+            own = matching
+        else:
+            own = matching[:shared] + [
+                check(c % args.interfaces, "config-%d-%d" % (k, c))
+                for c in range(shared, checks)
+            ]
+        write(
+            os.path.join(configs, "bench_%06d.json" % k),
+            config("Bench %d" % k, own),
+        )
+
+    write(
+        os.path.join(data, "default_platform_configuration.json"),
+        config("Bench default", []),
+    )
+
+
+if __name__ == "__main__":
+    main()
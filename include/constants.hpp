@@ -15,6 +15,9 @@
  * limitations under the License.
  */
 
+#pragma once
+
+#include <chrono>
 #include <string>
 
 namespace constants
@@ -27,8 +30,18 @@ const std::string PCM_PLATFORM_CONF_PATH = PCM_DATA_DIR +
                                            "platform-configuration-files/";
 const std::string PCM_DEFAULT_PLATFORM_CONF_FILE = PCM_DATA_DIR +
                                                    DEFAULT_CONF_FILE_NAME;
+const std::string PCM_REPORT_FILE = "/run/nvidia-pcm-report.json";
+/** Name of the platform in the systemd manager environment, the generic
+ *  NAME of the environment file would leak into every unit */
+constexpr auto PCM_MANAGER_NAME = "PCM_NAME";
 
 constexpr auto MATCH_ALL = "matchall";
 constexpr auto MATCH_ONE = "matchone";
 
+/** Quiet period closing a burst of platform configuration file changes */
+constexpr std::chrono::milliseconds RELOAD_DEBOUNCE{500};
+
+/** Period of the metrics textfile updates in watch mode */
+constexpr std::chrono::seconds METRICS_INTERVAL{60};
+
 } // namespace constants
@@ -28,6 +28,8 @@ constexpr auto objectMapper = "xyz.openbmc_project.ObjectMapper";
 constexpr auto entityManager = "xyz.openbmc_project.EntityManager";
 constexpr auto fruManager = "com.Nvidia.FruManager";
 constexpr auto nsmd = "nsmd.service";
+constexpr auto systemd = "org.freedesktop.systemd1";
+constexpr auto pcm = "com.Nvidia.PCM";
 } // namespace service_name
 
 namespace object_path
@@ -42,6 +44,8 @@ constexpr auto bmcState = "/xyz/openbmc_project/state/bmc0";
 constexpr auto chassisState = "/xyz/openbmc_project/state/chassis0";
 constexpr auto hostState = "/xyz/openbmc_project/state/host0";
 constexpr auto pldm = "/xyz/openbmc_project/pldm";
+constexpr auto systemd = "/org/freedesktop/systemd1";
+constexpr auto pcm = "/xyz/openbmc_project/pcm";
 } // namespace object_path
 
 namespace interface
@@ -72,6 +76,8 @@ constexpr auto dumpEntry = "xyz.openbmc_project.Dump.Entry";
 constexpr auto dumpProgress = "xyz.openbmc_project.Common.Progress";
 constexpr auto hwIsolationCreate = "org.open_power.HardwareIsolation.Create";
 constexpr auto bootRawProgress = "xyz.openbmc_project.State.Boot.Raw";
+constexpr auto systemdManager = "org.freedesktop.systemd1.Manager";
+constexpr auto pcmResult = "com.Nvidia.PCM.Result";
 } // namespace interface
 
 /**
@@ -130,4 +136,32 @@ DBusPathList getPaths(const DBusInterfaceList& interfaces);
  */
 DBusSubTree getSubTree(const std::string& interface);
 
+/**
+ * @brief Pushes environment variables into the systemd manager with a single
+ *        'SetEnvironment' (or 'UnsetAndSetEnvironment') method call.
+ *
+ * Units started afterwards inherit the variables without reading any file.
+ * The default bus is used, so exporting DBUS_STARTER_BUS_TYPE=session lets
+ * this run against a local 'dbus-daemon --session' stand-in.
+ *
+ * @param[in] unset - Variable names to drop from the manager environment
+ * @param[in] assignments - The "KEY=VALUE" assignments to set
+ */
+void setManagerEnvironment(const std::vector<std::string>& unset,
+                           const std::vector<std::string>& assignments);
+
+/**
+ * @brief Renders a property value as text, for logs and reports.
+ *
+ * @param[in] value - The property value
+ *
+ * @return The value as text, strings are returned as is.
+ */
+std::string toString(const DBusValue& value);
+
+/**
+ * @brief Number of D-Bus method calls issued through this accessor so far.
+ */
+uint64_t getCallCount();
+
 } // namespace dbus
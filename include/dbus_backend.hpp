@@ -0,0 +1,135 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "dbus_types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+namespace dbus
+{
+
+/**
+ * @brief Source of the inventory data the platform checks are evaluated
+ *        against.
+ *
+ * The checks never talk to D-Bus directly, so the same engine can run against
+ * the live bus, a recorded snapshot or an in-memory fake. Implementations
+ * used with platform_matcher::PlatformMatcher::evaluate() from several
+ * threads at once must be thread-safe.
+ */
+class Backend
+{
+  public:
+    virtual ~Backend() = default;
+
+    /** @brief See dbus::getSubTree(), the reply is shared with the caller */
+    virtual DBusSubTreePtr getSubTree(const std::string& interface) = 0;
+
+    /** @brief See dbus::getProperty() */
+    virtual void getProperty(const std::string& service,
+                             const std::string& objectPath,
+                             const std::string& interface,
+                             const std::string& property,
+                             DBusValue& value) = 0;
+};
+
+/**
+ * @brief Backend using the D-Bus accessor functions on the default bus.
+ *
+ * Thread-safe, the default bus is per-thread.
+ */
+class SystemBackend : public Backend
+{
+  public:
+    DBusSubTreePtr getSubTree(const std::string& interface) override;
+    void getProperty(const std::string& service, const std::string& objectPath,
+                     const std::string& interface, const std::string& property,
+                     DBusValue& value) override;
+};
+
+/**
+ * @brief Memoizes the replies of another backend.
+ *
+ * Most platform configs query the same interfaces, a cache scoped to one
+ * evaluation turns the repeated GetSubTree and Get calls into lookups.
+ * Failures are memoized as well. Not thread-safe, use one per evaluation.
+ *
+ * The map nodes and their keys are allocated from a monotonic arena owned by
+ * the cache: a lookup allocates nothing and the whole cache is released at
+ * once with the evaluation. The cached subtrees are shared with the callers.
+ */
+class CachedBackend : public Backend
+{
+  public:
+    explicit CachedBackend(Backend& backend) : backend(backend) {}
+    CachedBackend(const CachedBackend&) = delete;
+    CachedBackend& operator=(const CachedBackend&) = delete;
+
+    DBusSubTreePtr getSubTree(const std::string& interface) override;
+    void getProperty(const std::string& service, const std::string& objectPath,
+                     const std::string& interface, const std::string& property,
+                     DBusValue& value) override;
+
+    /** @brief Number of requests answered from the cache */
+    uint64_t getHits() const
+    {
+        return hits;
+    }
+
+    /** @brief Number of requests forwarded to the underlying backend */
+    uint64_t getMisses() const
+    {
+        return misses;
+    }
+
+  private:
+    /** @brief Service, object path, interface and property */
+    using PropertyKey = std::tuple<std::string_view, std::string_view,
+                                   std::string_view, std::string_view>;
+
+    template <typename T>
+    struct Entry
+    {
+        T value;
+        std::exception_ptr error;
+    };
+
+    /** @brief Copy of a key in the arena, valid as long as the cache */
+    std::string_view keep(std::string_view key);
+
+    Backend& backend;
+    /** @brief First block of the arena, enough for a few configs */
+    std::array<std::byte, 4096> initialBlock;
+    std::pmr::monotonic_buffer_resource arena{initialBlock.data(),
+                                              initialBlock.size()};
+    std::pmr::map<std::string_view, Entry<DBusSubTreePtr>> subTrees{&arena};
+    std::pmr::map<PropertyKey, Entry<DBusValue>> properties{&arena};
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+} // namespace dbus
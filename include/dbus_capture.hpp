@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Capture and replay of the inventory seen by the platform checks.
+ *
+ * A RecordingBackend forwards the requests of the engine to another backend
+ * and records every reply, or failure, with its latency. save() writes them
+ * as a compact CBOR document. A ReplayBackend answers the same requests
+ * from such a file on any machine, so a detection seen in the field can be
+ * reproduced, profiled and regression-tested without the live FruManager
+ * and nsmd.
+ *
+ * @code
+ *   dbus::SystemBackend system;
+ *   dbus::RecordingBackend recorder(system);
+ *   matcher.evaluate(recorder);
+ *   recorder.save("/tmp/inventory.cbor");
+ *
+ *   dbus::ReplayBackend replay("/tmp/inventory.cbor",
+ *                              dbus::ReplayTiming::fast);
+ *   matcher.evaluate(replay);
+ * @endcode
+ */
+
+#include "dbus_backend.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dbus
+{
+
+/** @brief Version of the capture format */
+constexpr int CAPTURE_VERSION = 1;
+
+/**
+ * @brief Records the replies of another backend.
+ *
+ * Thread-safe if the underlying backend is.
+ */
+class RecordingBackend : public Backend
+{
+  public:
+    explicit RecordingBackend(Backend& backend) : backend(backend) {}
+
+    DBusSubTreePtr getSubTree(const std::string& interface) override;
+    void getProperty(const std::string& service, const std::string& objectPath,
+                     const std::string& interface, const std::string& property,
+                     DBusValue& value) override;
+
+    /** @brief Write the replies recorded so far as CBOR
+     *
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void save(const std::string& file) const;
+
+  private:
+    Backend& backend;
+    mutable std::mutex mutex;
+    nlohmann::json subTrees = nlohmann::json::array();
+    nlohmann::json properties = nlohmann::json::array();
+};
+
+enum class ReplayTiming
+{
+    real, // Wait for the recorded latency of each reply
+    fast  // Reply at once
+};
+
+/** @brief Parse "real" or "fast"
+ *
+ * @throw std::invalid_argument for any other name
+ */
+ReplayTiming replayTimingFromName(const std::string& name);
+
+/**
+ * @brief Replies with the responses of a capture.
+ *
+ * A request recorded several times gets the recorded replies in order, the
+ * last one is repeated. A request missing from the capture fails like an
+ * unknown D-Bus object. Thread-safe.
+ */
+class ReplayBackend : public Backend
+{
+  public:
+    /** @throw std::runtime_error if the file is not a valid capture */
+    ReplayBackend(const std::string& file, ReplayTiming timing);
+
+    DBusSubTreePtr getSubTree(const std::string& interface) override;
+    void getProperty(const std::string& service, const std::string& objectPath,
+                     const std::string& interface, const std::string& property,
+                     DBusValue& value) override;
+
+  private:
+    /** @brief Recorded replies of one request, next is the one to return */
+    struct Replies
+    {
+        std::vector<nlohmann::json> replies;
+        size_t next = 0;
+    };
+
+    /** @brief Wait as recorded, then the reply, or throw its error */
+    const nlohmann::json& reply(const std::string& key);
+
+    ReplayTiming timing;
+    std::mutex mutex;
+    std::map<std::string, Replies> requests;
+};
+
+} // namespace dbus
@@ -20,6 +20,7 @@
 #include <sdbusplus/bus.hpp>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <variant>
 #include <vector>
@@ -42,5 +43,7 @@ using DBusPropertyMap = std::pair<DBusProperty, DBusValue>;
 using DBusInterfaceMap = std::pair<DBusInterface, DBusPropertyMap>;
 using DBusSubTree =
     std::map<DBusPath, std::map<DBusService, DBusInterfaceList>>;
+/** @brief A decoded GetSubTree reply, shared instead of copied */
+using DBusSubTreePtr = std::shared_ptr<const DBusSubTree>;
 
 } // namespace dbus
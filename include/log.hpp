@@ -35,12 +35,27 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "log_binary.hpp"
+#include "log_ctrl.hpp"
+#include "log_flight.hpp"
+
+#include <fmt/format.h>
+#include <fmt/printf.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace logging
@@ -58,6 +73,10 @@ namespace logging
  * It is also possible to specify a user message following printf standard
  *   format, example:  log_elapsed("(inside loop) counter=%d", counter)
  *
+ * Each thread has its own tree, printed when its outermost entry point
+ *  ends. The entry points are also recorded as "elapsed" spans when tracing
+ *  is started, see log_trace.hpp.
+ *
  * Entry points are defined by the execution flow, the first macro called will
  *  generate the first entry point (level 00), others called during the
  *  execution flow will added into the tree which is a LIFO queue.
@@ -125,16 +144,20 @@ namespace logging
 class LogElapsedTime
 {
   private: // static variables
-    /** @brief stores the tree messages, it is cleaned after printing */
-    static std::vector<std::string> _messages;
+    /** @brief stores the tree messages of the thread, it is cleaned after
+     *          printing */
+    static thread_local std::vector<std::string> _messages;
     /** @brief stores the the level/deep of current entry point */
-    static int _deep;
+    static thread_local int _deep;
 
   private:
-    /** @brief time stamp when the entry point starts its execution */
-    struct timespec _begin;
+    /** @brief CLOCK_MONOTONIC time in ns when the entry point starts its
+     *          execution */
+    int64_t _begin;
     /** @brief index in _messages for this entry point */
     size_t _msgIndex;
+    /** @brief function name, for the trace */
+    const char* _label;
 
   private:
     /** @brief calculates elapsed time remaking the string in _messages
@@ -162,9 +185,20 @@ class LogElapsedTime
  * Set debug level controller by,
  * #define DBG_LOG_CTRL x
  * #include "log.hpp"
+ * It holds a ctrl::Block, see log_ctrl.hpp.
  */
 #ifndef DBG_LOG_CTRL
-#define DBG_LOG_CTRL "nvoobaml_ctrl"
+#define DBG_LOG_CTRL "nvidia_pcm_log_ctrl"
+#endif
+
+/**
+ * Set the log category of a translation unit by,
+ * #define LOG_CATEGORY x
+ * #include "log.hpp"
+ * with x one of ctrl::Category.
+ */
+#ifndef LOG_CATEGORY
+#define LOG_CATEGORY main
 #endif
 
 /**
@@ -184,6 +218,8 @@ enum LogLevel
     information = 4,
 
     dataonly = 0x8000 | information,
+    /** Flag of messages written to the output only, never recorded */
+    outputonly = 0x4000,
 };
 
 /**
@@ -195,6 +231,240 @@ enum LogLevel
 #define DEF_DBG_LEVEL disabled
 #endif
 
+/**
+ * Set the least severe level compiled in by,
+ * #define LOG_MIN_LEVEL x
+ * #include "log.hpp"
+ * Log calls above it are removed at compile time, e.g. LOG_MIN_LEVEL
+ * warning drops every debug and information message.
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL information
+#endif
+
+/**
+ * Description of a log call, one per call site, built by the log macros.
+ * The format is printf-style, id identifies the site in binary logs. The
+ * mutable part is the state of the site's rate limit.
+ */
+struct LogSite
+{
+    const char* file;
+    int line;
+    const char* func;
+    const char* format;
+    uint32_t id;
+    ctrl::Category category;
+    /** Time in ns at which the token bucket is full again */
+    mutable std::atomic<int64_t> bucketFull{0};
+    mutable std::atomic<uint64_t> suppressed{0};
+    /** The site waits in the suppressed list of the logger */
+    mutable std::atomic<bool> suppressedListed{false};
+};
+
+#define LOG_INTERNAL_SITE(name, format)                                        \
+    inline constinit LogSite name                                              \
+    {                                                                          \
+        __FILE__, __LINE__, "log", format,                                     \
+            binary::siteId(__FILE__, __LINE__, format), ctrl::Category::main   \
+    }
+
+/**
+ * Formats of the messages the logger writes about the messages of another
+ * site, they are written with the location of that site
+ */
+LOG_INTERNAL_SITE(repeatedSite, "Last message repeated %lu times\n");
+LOG_INTERNAL_SITE(suppressedSite,
+                  "%lu messages suppressed by the rate limit\n");
+
+/**
+ * Rate limit of each call site for messages up to maxLevel, a token
+ * bucket holding burst messages and refilled with perSecond messages per
+ * second. perSecond 0 turns the limit off.
+ */
+struct LogRateLimit
+{
+    unsigned perSecond = 10;
+    unsigned burst = 20;
+    int maxLevel = LogLevel::warning;
+};
+
+/**
+ * Structured field attached to the journal entries logged by the current
+ * thread while the object lives, e.g.
+ *   LogField configField("PCM_CONFIG", config.name);
+ * The key must be a string literal made of upper case letters, digits and
+ * underscores. The value is not copied and must outlive the object.
+ */
+class LogField
+{
+  public:
+    using Fields = std::vector<std::pair<const char*, std::string_view>>;
+
+    LogField(const char* key, std::string_view value)
+    {
+        fields().emplace_back(key, value);
+    }
+
+    ~LogField()
+    {
+        fields().pop_back();
+    }
+
+    LogField(const LogField&) = delete;
+    LogField& operator=(const LogField&) = delete;
+
+    /** Fields of the current thread, innermost last */
+    static Fields& fields()
+    {
+        thread_local Fields stack;
+        return stack;
+    }
+};
+
+/**
+ * What a producer does when the asynchronous log ring is full
+ */
+enum class LogOverflow
+{
+    drop,  // Drop the message, drops are counted and reported. Errors are
+           // never dropped.
+    block, // Wait for the background thread to free a slot
+};
+
+/**
+ * Flush and rotation policy of the log file.
+ *
+ * Lines are collected in memory and written with a single writev() once
+ * flushBytes are pending, once flushInterval elapsed, or right away for
+ * errors. When rotateBytes is set, the file is renamed to file.1 before it
+ * would grow past it, keeping keepFiles old files.
+ */
+struct LogFileOptions
+{
+    size_t flushBytes = 4096;
+    std::chrono::milliseconds flushInterval{1000};
+    size_t rotateBytes = 0;
+    unsigned keepFiles = 3;
+};
+
+/**
+ * Steady clock optionally prefixed to every line, in microseconds
+ */
+enum class LogClock
+{
+    none,
+    monotonic, // CLOCK_MONOTONIC, stops while suspended
+    boottime,  // CLOCK_BOOTTIME, includes suspend
+};
+
+/**
+ * Message waiting in the asynchronous log ring.
+ *
+ * The message is formatted by the producer, the timestamp and severity are
+ * rendered by the background thread. Messages longer than text spill into
+ * longText, which is the only case allocating memory.
+ */
+struct LogRecord
+{
+    int level;
+    struct timespec ts;
+    struct timespec steady;
+    char text[208];
+    std::string longText;
+};
+
+/**
+ * Bounded lock-free multi-producer single-consumer ring of LogRecord.
+ *
+ * Each slot carries a sequence number telling whether it is free for the
+ * producer claiming position pos (seq == pos) or ready for the consumer
+ * (seq == pos + 1).
+ */
+class LogRing
+{
+  public:
+    static constexpr size_t capacity = 512;
+
+    struct Slot
+    {
+        std::atomic<size_t> seq;
+        LogRecord record;
+    };
+
+    LogRing()
+    {
+        for (size_t i = 0; i < capacity; i++)
+        {
+            slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /** Claim a slot for writing, returns nullptr if the ring is full */
+    Slot* claim(size_t& pos)
+    {
+        pos = head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = slots[pos % capacity];
+            auto seq = slot.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) -
+                        static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+                {
+                    return &slot;
+                }
+            }
+            else if (diff < 0)
+            {
+                return nullptr;
+            }
+            else
+            {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /** Hand a claimed slot over to the consumer */
+    void publish(Slot* slot, size_t pos)
+    {
+        slot->seq.store(pos + 1, std::memory_order_release);
+    }
+
+    /** Next slot ready for the consumer, nullptr if none */
+    Slot* peek()
+    {
+        Slot& slot = slots[tail % capacity];
+        if (slot.seq.load(std::memory_order_acquire) != tail + 1)
+        {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    /** Give the slot returned by peek() back to the producers */
+    void release(Slot* slot)
+    {
+        slot->seq.store(tail + capacity, std::memory_order_release);
+        tail++;
+    }
+
+    /** Number of slots claimed by producers so far */
+    size_t getHead() const
+    {
+        return head.load(std::memory_order_acquire);
+    }
+
+  private:
+    Slot slots[capacity];
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) size_t tail = 0;
+};
+
 class Log
 {
     using CtrlType = int;
@@ -210,22 +480,41 @@ class Log
 
     ~Log()
     {
+        reportPending();
+        setAsync(false);
+        stopFileFlusher();
         smDeinit();
         closeLogFile();
     }
 
+    /** Set the level of every category */
     void setLevel(CtrlType desiredLevel = DEF_DBG_LEVEL)
     {
-        setCtrlLevel(desiredLevel);
+        for (size_t i = 0; i < ctrl::categoryNames.size(); i++)
+        {
+            setLevel(static_cast<ctrl::Category>(i), desiredLevel);
+        }
     }
 
-    CtrlType getLevel(void)
+    void setLevel(ctrl::Category category, CtrlType desiredLevel)
     {
-        return getCtrlLevel();
+        ctrlBlock->levels[static_cast<size_t>(category)].store(
+            desiredLevel, std::memory_order_relaxed);
     }
 
+    CtrlType getLevel(ctrl::Category category = ctrl::Category::main) const
+    {
+        return ctrlBlock->levels[static_cast<size_t>(category)].load(
+            std::memory_order_relaxed);
+    }
+
+    /**
+     * Append to the given file instead of standard output, an empty name
+     * switches back. Lines of the previous runs are kept.
+     */
     void setLogFile(const std::string& file)
     {
+        stopFileFlusher();
         std::lock_guard<std::mutex> logGuard(lMutex);
 
         closeLogFile();
@@ -233,54 +522,486 @@ class Log
         openLogFile();
     }
 
-    void log(int desiredLevel, const char* fmt, ...)
+    void setLogFileOptions(const LogFileOptions& options)
     {
-        if (!isReady || getLogLevel(getLevel()) < getLogLevel(desiredLevel))
+        std::lock_guard<std::mutex> logGuard(lMutex);
+        fileOptions = options;
+    }
+
+    /**
+     * Switch between synchronous logging and asynchronous logging.
+     *
+     * In asynchronous mode producers format their message into a lock-free
+     * ring and return, a background thread adds timestamps and writes the
+     * messages in batches. Error messages wait until they are written, and
+     * the ring is drained when switching back and at exit, once the
+     * producers still using it are done.
+     */
+    void setAsync(bool enable, LogOverflow policy = LogOverflow::drop)
+    {
+        overflow.store(policy, std::memory_order_relaxed);
+        if (enable == (asyncThread.joinable()))
         {
-            // Should not print anything as log is not ready anyways
             return;
         }
 
+        if (enable)
+        {
+            ring = std::make_unique<LogRing>();
+            stopping.store(false);
+            asyncThread = std::thread([this]() { asyncWorker(); });
+            async.store(true, std::memory_order_release);
+        }
+        else
+        {
+            async.store(false);
+            // Producers which saw async set may still use the ring, the
+            // worker keeps writing until they are done
+            for (auto count = producers.load(); count != 0;
+                 count = producers.load())
+            {
+                producers.wait(count);
+            }
+            stopping.store(true);
+            pushed.fetch_add(1);
+            pushed.notify_one();
+            asyncThread.join();
+            ring.reset();
+        }
+    }
+
+    /**
+     * Prefix every line with the given steady clock in microseconds, which
+     * unlike the wall clock does not jump when the time is synchronized.
+     */
+    void setClock(LogClock clock)
+    {
+        steadyClock.store(clock, std::memory_order_relaxed);
+    }
+
+    /**
+     * Send messages to the systemd journal as structured entries instead of
+     * writing text lines. The entries carry PRIORITY, CODE_FILE, CODE_LINE,
+     * CODE_FUNC, PCM_CLASS for class members and the LogField of the
+     * logging thread. Journal entries are sent directly, also in
+     * asynchronous mode, as journald's socket does not block.
+     */
+    void setJournal(bool enable)
+    {
+        journal.store(enable, std::memory_order_relaxed);
+    }
+
+    /**
+     * Write binary records to the log file instead of text lines, see
+     * log_binary.hpp. Only the call site ID, the timestamps and the raw
+     * arguments are written, pcm-logdecode formats them offline. Takes
+     * effect while a log file is set, binary records bypass the
+     * asynchronous ring as they need no formatting.
+     */
+    void setBinary(bool enable);
+
+    /**
+     * Keep the messages up to the given level in the shared memory flight
+     * recorder, whatever the log level is. LogLevel::disabled stops
+     * recording.
+     */
+    void setFlightLevel(int level)
+    {
+        if (level > LogLevel::disabled && !flightRecorder)
+        {
+            flightRecorder = std::make_unique<flight::Recorder>();
+        }
+        flightLevel.store(level, std::memory_order_relaxed);
+    }
+
+    /** The flight recorder of this process, nullptr if not recording */
+    const flight::Recorder* getFlightRecorder() const
+    {
+        return flightRecorder.get();
+    }
+
+    void setRateLimit(const LogRateLimit& limit)
+    {
+        int64_t interval = (limit.perSecond == 0)
+                               ? 0
+                               : 1000000000 / static_cast<int64_t>(
+                                                  limit.perSecond);
+        tokenInterval.store(interval, std::memory_order_relaxed);
+        bucketSize.store(interval * std::max(1u, limit.burst),
+                         std::memory_order_relaxed);
+        rateLimitLevel.store(getLogLevel(limit.maxLevel),
+                             std::memory_order_relaxed);
+    }
+
+    /** Wait until every message logged so far is written */
+    void flush()
+    {
+        reportPending();
+        if (enterAsync())
+        {
+            waitWritten(ring->getHead());
+            leaveAsync();
+        }
         std::lock_guard<std::mutex> logGuard(lMutex);
-        std::stringstream ss;
-        if (!(getLogControl(desiredLevel) & LogLevel::dataonly))
+        flushLogFile();
+    }
+
+    /**
+     * Append "[sssss.uuuuuu][mm/dd/yy hh:mm:ss.nnnnnnnnn]S" without
+     * allocating, the steady clock part only when it was read.
+     *
+     * The date part is cached per thread and only formatted again when the
+     * second changes. Also used by pcm-logdecode.
+     */
+    static void appendHeader(fmt::memory_buffer& buffer, int desiredLevel,
+                             const struct timespec& ts,
+                             const struct timespec& steady)
+    {
+        struct SecondCache
         {
-            // Timestamp
-            ss << timestampString();
+            time_t second = -1;
+            char prefix[32];
+            size_t length = 0;
+        };
+        thread_local SecondCache cache;
+
+        if (steady.tv_sec >= 0)
+        {
+            fmt::format_to(fmt::appender(buffer), "[{}.{:06}]",
+                           static_cast<long>(steady.tv_sec),
+                           static_cast<long>(steady.tv_nsec / 1000));
+        }
 
-            // Severity
-            switch (getLogLevel(desiredLevel))
+        if (cache.second != ts.tv_sec)
+        {
+            struct tm tm;
+            gmtime_r(&ts.tv_sec, &tm);
+            cache.length = strftime(cache.prefix, sizeof(cache.prefix),
+                                    "[%D %T.", &tm);
+            cache.second = ts.tv_sec;
+        }
+        buffer.append(cache.prefix, cache.prefix + cache.length);
+
+        // Nanoseconds, zero padded to 9 digits
+        char digits[9];
+        auto ns = static_cast<unsigned long>(ts.tv_nsec);
+        for (int i = 8; i >= 0; i--)
+        {
+            digits[i] = static_cast<char>('0' + ns % 10);
+            ns /= 10;
+        }
+        buffer.append(digits, digits + sizeof(digits));
+        buffer.push_back(']');
+        buffer.push_back(severityChar(desiredLevel));
+    }
+
+    /**
+     * Append the text line of a decoded binary message of the given call
+     * site, as it would have been logged. Used by the decoding tools.
+     */
+    static void appendMessage(fmt::memory_buffer& out,
+                              const binary::Message& message,
+                              std::string_view file, int line,
+                              std::string_view func, std::string_view format)
+    {
+        appendHeader(out, message.flags & binary::levelMask, message.ts,
+                     message.steady);
+        if (message.flags & binary::classFlag)
+        {
+            fmt::format_to(fmt::appender(out), "[{}][{}]: ", message.klass,
+                           func);
+        }
+        else
+        {
+            fmt::format_to(fmt::appender(out), "[{}:{}][{}]: ", file, line,
+                           func);
+        }
+
+        if (message.flags & binary::formattedFlag)
+        {
+            out.append(message.text);
+            return;
+        }
+        auto size = out.size();
+        try
+        {
+            fmt::detail::vprintf(out, fmt::string_view(format),
+                                 fmt::printf_args(message.args));
+        }
+        catch (const std::exception& e)
+        {
+            out.resize(size);
+            fmt::format_to(fmt::appender(out), "{} (bad format: {})\n",
+                           format, e.what());
+        }
+    }
+
+    /**
+     * Whether a message of the given level would be written to the output
+     * or to the flight recorder, LogLevel::outputonly messages are never
+     * recorded
+     */
+    bool isEnabled(int desiredLevel,
+                   ctrl::Category category = ctrl::Category::main) const
+    {
+        return isReady &&
+               (getLogLevel(getLevel(category)) >= getLogLevel(desiredLevel) ||
+                isRecorded(desiredLevel));
+    }
+
+    /**
+     * Write a message for the call site, "[klass][func]: " prefixed when
+     * klass is given and "[file:line][func]: " otherwise.
+     *
+     * The message is formatted into a thread-local buffer which is reused,
+     * so it is neither truncated nor allocated per message.
+     */
+    template <typename... Args>
+    void log(int desiredLevel, const LogSite& site, const char* klass,
+             const Args&... args)
+    {
+        if (!isReady || (getLogControl(desiredLevel) & LogLevel::dataonly))
+        {
+            return;
+        }
+
+        bool toFlight = isRecorded(desiredLevel);
+        desiredLevel = getLogLevel(desiredLevel);
+        bool toOutput = getLogLevel(getLevel(site.category)) >= desiredLevel;
+        if (toOutput && !admit(desiredLevel, site, klass, toFlight, args...))
+        {
+            // The recorder keeps what the output drops
+            toOutput = false;
+        }
+        if (toFlight || toOutput)
+        {
+            write(desiredLevel, site, site, klass, toFlight, toOutput,
+                  args...);
+        }
+    }
+
+  private:
+    /** Whether a message of the given level goes to the flight recorder */
+    bool isRecorded(int desiredLevel) const
+    {
+        return !(getLogControl(desiredLevel) & LogLevel::outputonly) &&
+               flightLevel.load(std::memory_order_relaxed) >=
+                   getLogLevel(desiredLevel);
+    }
+
+    /**
+     * Drop identical consecutive messages, counted and reported as
+     * repeated, and apply the rate limit of the site. Only applies to
+     * messages written to the output, the flight recorder keeps them all.
+     * Lock-free, so a storm of messages never waits for the output.
+     */
+    template <typename... Args>
+    bool admit(int desiredLevel, const LogSite& site, const char* klass,
+               bool toFlight, const Args&... args)
+    {
+        auto key = messageKey(desiredLevel, site, klass, args...);
+        if (lastMessage.exchange(key, std::memory_order_relaxed) == key)
+        {
+            repeated.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        reportRepeated();
+        lastLevel.store(desiredLevel, std::memory_order_relaxed);
+        lastSite.store(&site, std::memory_order_relaxed);
+        lastToFlight.store(toFlight, std::memory_order_relaxed);
+
+        if (getLogLevel(desiredLevel) <=
+                rateLimitLevel.load(std::memory_order_relaxed) &&
+            !takeToken(site))
+        {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            if (!site.suppressedListed.exchange(true,
+                                                std::memory_order_relaxed))
             {
-                case LogLevel::error:
-                    ss << "E";
-                    break;
-                case LogLevel::warning:
-                    ss << "W";
-                    break;
-                case LogLevel::debug:
-                    ss << "D";
-                    break;
-                case LogLevel::information:
-                    ss << "I";
-                    break;
-                default:
-                    ss << "O";
-                    break;
+                std::lock_guard<std::mutex> guard(suppressedMutex);
+                suppressedSites.push_back({&site, desiredLevel, toFlight});
             }
+            return false;
+        }
+
+        auto suppressed = site.suppressed.exchange(0,
+                                                   std::memory_order_relaxed);
+        if (suppressed != 0)
+        {
+            write(desiredLevel, suppressedSite, site, nullptr, toFlight, true,
+                  suppressed);
+        }
+        return true;
+    }
+
+    /** Hash of the site and the raw arguments of a message */
+    template <typename... Args>
+    static uint64_t messageKey(int desiredLevel, const LogSite& site,
+                               const char* klass, const Args&... args)
+    {
+        thread_local fmt::memory_buffer buffer;
+        buffer.clear();
+        binary::put(buffer, site.id);
+        binary::put(buffer, desiredLevel);
+        binary::put(buffer, klass);
+        (binary::putArg(buffer, args), ...);
+
+        uint64_t hash = 14695981039346656037ull;
+        for (auto c : buffer)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /** Take a token from the bucket of the site, false if it is empty */
+    bool takeToken(const LogSite& site)
+    {
+        auto interval = tokenInterval.load(std::memory_order_relaxed);
+        if (interval == 0)
+        {
+            return true;
+        }
+        auto size = bucketSize.load(std::memory_order_relaxed);
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+        int64_t nowNs = now.tv_sec * 1000000000ll + now.tv_nsec;
+
+        // The bucket holds (size - (full - now)) / interval tokens
+        auto full = site.bucketFull.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto base = std::max(full, nowNs);
+            if (base + interval - nowNs > size)
+            {
+                return false;
+            }
+            if (site.bucketFull.compare_exchange_weak(
+                    full, base + interval, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+    }
 
-            // Message
-            char msg[1024] = {0};
-            va_list args;
-            va_start(args, fmt);
-            vsnprintf(msg, sizeof(msg), fmt, args);
-            va_end(args);
+    /** Write the number of repeats of the last message, if any */
+    void reportRepeated()
+    {
+        if (repeated.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+        auto count = repeated.exchange(0, std::memory_order_relaxed);
+        const auto* site = lastSite.load(std::memory_order_relaxed);
+        if (count != 0 && site != nullptr)
+        {
+            write(lastLevel.load(std::memory_order_relaxed), repeatedSite,
+                  *site, nullptr, lastToFlight.load(std::memory_order_relaxed),
+                  true, count);
+        }
+    }
 
-            ss << msg;
+    /** Write the repeats and the rate limited messages not reported yet */
+    void reportPending()
+    {
+        reportRepeated();
 
-            outputLog(ss.str());
+        std::vector<SuppressedSite> sites;
+        {
+            std::lock_guard<std::mutex> guard(suppressedMutex);
+            sites.swap(suppressedSites);
+        }
+        for (const auto& [site, level, toFlight] : sites)
+        {
+            site->suppressedListed.store(false, std::memory_order_relaxed);
+            auto count = site->suppressed.exchange(0,
+                                                   std::memory_order_relaxed);
+            if (count != 0)
+            {
+                write(level, suppressedSite, *site, nullptr, toFlight, true,
+                      count);
+            }
         }
     }
 
+    /**
+     * Write an admitted message to the flight recorder and the output. The
+     * format comes from site and the location from origin, which differ for
+     * the messages the logger writes about another site.
+     */
+    template <typename... Args>
+    void write(int desiredLevel, const LogSite& site, const LogSite& origin,
+               const char* klass, bool toFlight, bool toOutput,
+               const Args&... args)
+    {
+        // Messages about another site get an ID of their own
+        uint32_t id = (&site == &origin) ? site.id
+                                         : (origin.id * 16777619u) ^ site.id;
+        if (toFlight)
+        {
+            recordFlight(desiredLevel, id, site, origin, klass, args...);
+        }
+        if (!toOutput)
+        {
+            return;
+        }
+
+        auto& buffer = formatBuffer();
+        buffer.clear();
+        if (journal.load(std::memory_order_relaxed))
+        {
+            buffer.append(std::string_view("MESSAGE="));
+            formatPrintf(buffer, site.format, args...);
+            journalSend(desiredLevel, origin, klass, buffer);
+            return;
+        }
+
+        struct timespec ts;
+        struct timespec steady;
+        readClocks(ts, steady);
+
+        if (binaryMode.load(std::memory_order_relaxed))
+        {
+            binary::putMessage(buffer, id, getLogLevel(desiredLevel), ts,
+                               steady, klass, args...);
+            writeBinary(desiredLevel, id, site, origin,
+                        {buffer.data(), buffer.size()});
+            return;
+        }
+
+        bool asyncMode = enterAsync();
+        if (!asyncMode)
+        {
+            // Asynchronous records get their header from the consumer
+            appendHeader(buffer, desiredLevel, ts, steady);
+        }
+        if (klass != nullptr)
+        {
+            fmt::format_to(fmt::appender(buffer), "[{}][{}]: ", klass,
+                           origin.func);
+        }
+        else
+        {
+            fmt::format_to(fmt::appender(buffer), "[{}:{}][{}]: ", origin.file,
+                           origin.line, origin.func);
+        }
+        formatPrintf(buffer, site.format, args...);
+
+        if (asyncMode)
+        {
+            logAsync(desiredLevel, ts, steady, {buffer.data(), buffer.size()});
+            leaveAsync();
+            return;
+        }
+
+        std::lock_guard<std::mutex> logGuard(lMutex);
+        outputLog({buffer.data(), buffer.size()},
+                  getLogLevel(desiredLevel) == LogLevel::error);
+    }
+
+  public:
     void log_raw(int desiredLevel, const char* msg,
                  const std::vector<uint8_t>& array, size_t size)
     {
@@ -290,13 +1011,15 @@ class Log
             return;
         }
 
+        // Keep ordering with messages still in the asynchronous ring
+        flush();
+
         std::lock_guard<std::mutex> logGuard(lMutex);
         std::stringstream ss;
-        // Timestamp
-        ss << timestampString();
-
-        // Severity
-        ss << "I";
+        // Timestamp and severity
+        fmt::memory_buffer header;
+        appendHeader(header, LogLevel::information);
+        ss << std::string_view(header.data(), header.size());
 
         ss << "[raw]:";
 
@@ -324,13 +1047,15 @@ class Log
             return;
         }
 
+        // Keep ordering with messages still in the asynchronous ring
+        flush();
+
         std::lock_guard<std::mutex> logGuard(lMutex);
         std::stringstream ss;
-        // Timestamp
-        ss << timestampString();
-
-        // Severity
-        ss << "I";
+        // Timestamp and severity
+        fmt::memory_buffer header;
+        appendHeader(header, LogLevel::information);
+        ss << std::string_view(header.data(), header.size());
 
         ss << "[raw]:";
 
@@ -368,10 +1093,18 @@ class Log
 
     std::string logFile;
     std::string logCtrlName;
-    std::fstream logStream;
+    int logFd = -1;
+    size_t logFileSize = 0;
+    LogFileOptions fileOptions;
+    /** Lines not written to the log file yet */
+    fmt::memory_buffer pendingLines;
+    std::chrono::steady_clock::time_point lastFileFlush;
+    std::thread fileFlusher;
+    std::condition_variable fileFlusherCv;
+    bool fileFlusherStop = false;
 
     int smfd;
-    CtrlType* ctrlLevel;
+    ctrl::Block* ctrlBlock;
 
     CtrlType initLevel;
 
@@ -379,65 +1112,364 @@ class Log
 
     unsigned long long seq;
 
-    CtrlType getCtrlLevel() const
+    std::unique_ptr<LogRing> ring;
+    std::thread asyncThread;
+    std::atomic<bool> async{false};
+    /** Threads using the ring, see enterAsync() */
+    std::atomic<int> producers{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<LogOverflow> overflow{LogOverflow::drop};
+    std::atomic<LogClock> steadyClock{LogClock::none};
+    std::atomic<bool> journal{false};
+    std::unique_ptr<flight::Recorder> flightRecorder;
+    std::atomic<int> flightLevel{LogLevel::disabled};
+    /** Dedup of consecutive messages, see admit() */
+    std::atomic<uint64_t> lastMessage{0};
+    std::atomic<uint64_t> repeated{0};
+    std::atomic<int> lastLevel{LogLevel::information};
+    std::atomic<const LogSite*> lastSite{nullptr};
+    std::atomic<bool> lastToFlight{false};
+    /** Sites with rate limited messages, reported by the next message of
+     *  the site or by flush() */
+    struct SuppressedSite
+    {
+        const LogSite* site;
+        int level;
+        bool toFlight;
+    };
+    std::mutex suppressedMutex;
+    std::vector<SuppressedSite> suppressedSites;
+    /** Rate limit, see setRateLimit(), defaults of LogRateLimit */
+    std::atomic<int64_t> tokenInterval{100000000};
+    std::atomic<int64_t> bucketSize{2000000000};
+    std::atomic<int> rateLimitLevel{LogLevel::warning};
+    /** Binary mode was requested, binaryMode is set while a file is open */
+    bool binaryRequested = false;
+    std::atomic<bool> binaryMode{false};
+    /** Location and format of the sites written to binary logs so far */
+    struct BinarySite
+    {
+        const char* file;
+        int line;
+        const char* func;
+        const char* format;
+    };
+    std::unordered_map<uint32_t, BinarySite> binarySites;
+    /** Bumped for every message pushed, the consumer sleeps on it */
+    std::atomic<uint32_t> pushed{0};
+    /** Messages written by the consumer, i.e. the ring position it reached.
+     *  Flushing producers wait on it. */
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> consumerSleeping{false};
+    std::atomic<int> flushWaiters{0};
+
+    /**
+     * Send the "MESSAGE=..." in buffer with the call site and thread fields
+     * to the journal, written as a text line if the journal is unreachable
+     */
+    void journalSend(int desiredLevel, const LogSite& site, const char* klass,
+                     fmt::memory_buffer& buffer);
+
+    /** Write a binary message record, preceded by the site record the
+     *  first time the site is used */
+    void writeBinary(int desiredLevel, uint32_t id, const LogSite& site,
+                     const LogSite& origin, std::string_view record);
+
+    /** Write the magic and the records of every site seen so far, so the
+     *  file can be decoded on its own. Called with lMutex held. */
+    void writeBinaryPreamble();
+
+    template <typename... Args>
+    void recordFlight(int desiredLevel, uint32_t id, const LogSite& site,
+                      const LogSite& origin, const char* klass,
+                      const Args&... args)
     {
-        return *ctrlLevel - '0';
+        struct timespec ts;
+        struct timespec steady;
+        readClocks(ts, steady);
+
+        auto& buffer = formatBuffer();
+        buffer.clear();
+        binary::putMessage(buffer, id, getLogLevel(desiredLevel), ts, steady,
+                           klass, args...);
+        if (buffer.size() > flight::Recorder::maxRecord)
+        {
+            // Too long for a slot, keep the beginning of the message
+            buffer.clear();
+            formatPrintf(buffer, site.format, args...);
+            constexpr size_t maxText = flight::Recorder::maxRecord - 80;
+            if (buffer.size() > maxText)
+            {
+                buffer.resize(maxText);
+                buffer.append(std::string_view("...\n"));
+            }
+            fmt::memory_buffer record;
+            binary::putMessage(record, id,
+                               getLogLevel(desiredLevel) |
+                                   binary::formattedFlag,
+                               ts, steady, klass,
+                               std::string_view(buffer.data(), buffer.size()));
+            flightRecorder->record(id, origin.file, origin.line, origin.func,
+                                   site.format, {record.data(), record.size()});
+            return;
+        }
+        flightRecorder->record(id, origin.file, origin.line, origin.func,
+                               site.format, {buffer.data(), buffer.size()});
     }
-    void setCtrlLevel(const CtrlType& level)
+
+    static fmt::memory_buffer& formatBuffer()
     {
-        *ctrlLevel = level + '0';
+        thread_local fmt::memory_buffer buffer;
+        return buffer;
     }
 
-    void openLogFile()
+    template <typename... Args>
+    static void formatPrintf(fmt::memory_buffer& buffer, const char* format,
+                             const Args&... args)
     {
-        if (logFile.size() == 0)
+        auto size = buffer.size();
+        try
         {
-            return;
+            fmt::detail::vprintf(buffer, fmt::string_view(format),
+                                 fmt::printf_args(
+                                     fmt::make_printf_args(args...)));
+        }
+        catch (const std::exception& e)
+        {
+            // Keep the call site visible rather than losing the message
+            std::string_view view(format);
+            if (!view.empty() && view.back() == '\n')
+            {
+                view.remove_suffix(1);
+            }
+            buffer.resize(size);
+            fmt::format_to(fmt::appender(buffer), "{} (bad format: {})\n",
+                           view, e.what());
         }
+    }
 
-        // to file
-        logStream.open(logFile, std::ios::out);
-        if (!logStream.is_open())
+    /**
+     * Whether asynchronous logging is on, in which case the ring may be
+     * used until leaveAsync() is called. setAsync(false) stores async
+     * before reading producers and this increments producers before
+     * reading async again, so either the caller sees async cleared or
+     * setAsync() waits for it.
+     */
+    bool enterAsync()
+    {
+        if (!async.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        producers.fetch_add(1);
+        if (async.load())
         {
-            throw std::runtime_error("Log file (" + logFile + ") open failed!");
+            return true;
         }
+        leaveAsync();
+        return false;
     }
 
-    void closeLogFile()
+    void leaveAsync()
     {
-        // to file
-        if (logStream.is_open())
+        if (producers.fetch_sub(1) == 1 && !async.load())
         {
-            log(LogLevel::information, "=========== End ===========\n");
-            logStream.flush();
-            logStream.close();
+            producers.notify_all();
         }
     }
 
-    void outputLog(const std::string& msg)
+    void logAsync(int desiredLevel, const struct timespec& ts,
+                  const struct timespec& steady, std::string_view msg)
     {
-        if (logStream.is_open())
+        size_t pos = 0;
+        LogRing::Slot* slot = ring->claim(pos);
+        while (slot == nullptr)
+        {
+            // Errors are never dropped
+            if (overflow.load(std::memory_order_relaxed) == LogOverflow::drop &&
+                getLogLevel(desiredLevel) != LogLevel::error)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            std::this_thread::yield();
+            slot = ring->claim(pos);
+        }
+
+        auto& record = slot->record;
+        record.level = desiredLevel;
+        record.ts = ts;
+        record.steady = steady;
+        if (msg.size() < sizeof(record.text))
         {
-            logStream << msg << std::flush;
+            memcpy(record.text, msg.data(), msg.size());
+            record.text[msg.size()] = '\0';
+            record.longText.clear();
         }
         else
         {
-            std::cout << msg << std::flush;
+            record.longText.assign(msg);
+        }
+
+        ring->publish(slot, pos);
+        pushed.fetch_add(1);
+        if (consumerSleeping.load())
+        {
+            pushed.notify_one();
+        }
+
+        // Errors are written before returning, they may precede a crash
+        if (getLogLevel(desiredLevel) == LogLevel::error)
+        {
+            waitWritten(pos + 1);
         }
     }
 
-    const std::string timestampString()
+    void waitWritten(uint64_t count)
     {
-        std::stringstream ss;
-        struct timespec ts;
-        clock_gettime(CLOCK_REALTIME, &ts);
-        char buf[100] = {0};
-        strftime(buf, sizeof(buf), "%D %T", gmtime(&ts.tv_sec));
+        flushWaiters.fetch_add(1);
+        for (auto current = written.load(); current < count;
+             current = written.load())
+        {
+            written.wait(current);
+        }
+        flushWaiters.fetch_sub(1);
+    }
+
+    void asyncWorker()
+    {
+        fmt::memory_buffer batch;
+        for (;;)
+        {
+            uint64_t count = 0;
+            bool urgent = false;
+            while (auto slot = ring->peek())
+            {
+                const auto& record = slot->record;
+                urgent |= getLogLevel(record.level) == LogLevel::error;
+                appendHeader(batch, record.level, record.ts, record.steady);
+                if (record.longText.empty())
+                {
+                    batch.append(std::string_view(record.text));
+                }
+                else
+                {
+                    batch.append(record.longText);
+                }
+                ring->release(slot);
+                count++;
+            }
+
+            auto drops = dropped.exchange(0, std::memory_order_relaxed);
+            if (drops != 0)
+            {
+                struct timespec ts;
+                struct timespec steady;
+                readClocks(ts, steady);
+                appendHeader(batch, LogLevel::warning, ts, steady);
+                fmt::format_to(fmt::appender(batch),
+                               "[log]: {} messages dropped, log ring full\n",
+                               drops);
+            }
+
+            if (batch.size() != 0)
+            {
+                {
+                    std::lock_guard<std::mutex> logGuard(lMutex);
+                    outputLog({batch.data(), batch.size()}, urgent);
+                }
+                batch.clear();
+                written.fetch_add(count);
+                if (flushWaiters.load() != 0)
+                {
+                    written.notify_all();
+                }
+                continue;
+            }
 
-        ss << "[" << buf << "." << std::setfill('0') << std::setw(9)
-           << ts.tv_nsec << "]";
+            if (stopping.load())
+            {
+                return;
+            }
 
-        return ss.str();
+            consumerSleeping.store(true);
+            auto seen = pushed.load();
+            if (ring->peek() == nullptr && !stopping.load())
+            {
+                pushed.wait(seen);
+            }
+            consumerSleeping.store(false);
+        }
+    }
+
+    /** Open logFile for appending, called with lMutex held */
+    void openLogFile();
+
+    /** Flush and close the log file, called with lMutex held */
+    void closeLogFile();
+
+    /** Write pending lines to the log file, called with lMutex held */
+    void flushLogFile();
+
+    /** Write both parts to the log file with one writev() */
+    void writeLogFile(std::string_view first, std::string_view second);
+
+    /** Rename the log file to file.1 and start a new one */
+    void rotateLogFile();
+
+    /** Write msg to the log file or standard output, called with lMutex
+     *  held. Urgent messages are written to the file right away. */
+    void outputLog(std::string_view msg, bool urgent = false);
+
+    /** Start the thread flushing pending lines at most flushInterval
+     *  after the previous flush, it sleeps while no line is pending */
+    void startFileFlusher();
+
+    /** Stop the flushing thread, called without lMutex held */
+    void stopFileFlusher();
+
+    static char severityChar(int desiredLevel)
+    {
+        switch (getLogLevel(desiredLevel))
+        {
+            case LogLevel::error:
+                return 'E';
+            case LogLevel::warning:
+                return 'W';
+            case LogLevel::debug:
+                return 'D';
+            case LogLevel::information:
+                return 'I';
+            default:
+                return 'O';
+        }
+    }
+
+    void readClocks(struct timespec& ts, struct timespec& steady) const
+    {
+        clock_gettime(CLOCK_REALTIME, &ts);
+        switch (steadyClock.load(std::memory_order_relaxed))
+        {
+            case LogClock::monotonic:
+                clock_gettime(CLOCK_MONOTONIC, &steady);
+                break;
+            case LogClock::boottime:
+                clock_gettime(CLOCK_BOOTTIME, &steady);
+                break;
+            default:
+                steady = {-1, 0};
+                break;
+        }
+    }
+
+    /** Header for a line written now */
+    void appendHeader(fmt::memory_buffer& buffer, int desiredLevel) const
+    {
+        struct timespec ts;
+        struct timespec steady;
+        readClocks(ts, steady);
+        appendHeader(buffer, desiredLevel, ts, steady);
     }
 
     int smInit()
@@ -466,23 +1498,24 @@ class Log
             }
         }
 
-        int rc = ftruncate(smfd, sizeof(CtrlType));
+        int rc = ftruncate(smfd, sizeof(ctrl::Block));
         if (-1 == rc)
         {
             throw std::runtime_error("SMEM truncate failed!");
         }
 
-        ctrlLevel = (CtrlType*)mmap(NULL, sizeof(CtrlType),
-                                    PROT_READ | PROT_WRITE, MAP_SHARED, smfd,
-                                    0);
-        if (ctrlLevel == MAP_FAILED)
+        ctrlBlock = (ctrl::Block*)mmap(NULL, sizeof(ctrl::Block),
+                                       PROT_READ | PROT_WRITE, MAP_SHARED,
+                                       smfd, 0);
+        if (ctrlBlock == MAP_FAILED)
         {
             throw std::runtime_error("Map failed!");
         }
 
-        if (isFirstSMHdl)
+        // A block left by an older layout is set up again
+        if (isFirstSMHdl || !ctrl::isValid(*ctrlBlock))
         {
-            setLevel(initLevel);
+            ctrl::initBlock(*ctrlBlock, initLevel);
         }
 
         isReady = true;
@@ -492,7 +1525,7 @@ class Log
 
     int smDeinit()
     {
-        int rc = munmap(ctrlLevel, sizeof(*ctrlLevel));
+        int rc = munmap(ctrlBlock, sizeof(*ctrlBlock));
         if (-1 == rc)
         {
             throw std::runtime_error("Unmap failed!");
@@ -531,41 +1564,137 @@ extern Log logger;
  **/
 #define log_set_level(dl) logger.setLevel(dl)
 
+/**
+ * log_set_category_level() is to change the level of one ctrl::Category
+ **/
+#define log_set_category_level(category, dl) logger.setLevel(category, dl)
+
 /**
  * log_get_level() is to get debug log level
  **/
 #define log_get_level() logger.getLevel()
 
+/**
+ * log_set_async() is to switch to asynchronous logging with the given
+ *  LogOverflow policy, log_set_sync() back to synchronous logging
+ **/
+#define log_set_async(policy) logger.setAsync(true, policy)
+#define log_set_sync() logger.setAsync(false)
+
+/**
+ * log_set_file_options() is to change the LogFileOptions of the log file
+ **/
+#define log_set_file_options(options) logger.setLogFileOptions(options)
+
+/**
+ * log_set_binary() is to write binary records to the log file, decoded by
+ *  pcm-logdecode
+ **/
+#define log_set_binary(enable) logger.setBinary(enable)
+
+/**
+ * log_set_flight() is to keep messages up to the given level in the shared
+ *  memory flight recorder
+ **/
+#define log_set_flight(level) logger.setFlightLevel(level)
+
+/**
+ * log_set_clock() is to prefix every line with a steady LogClock
+ **/
+#define log_set_clock(clock) logger.setClock(clock)
+
+/**
+ * log_set_journal() is to send messages to the systemd journal
+ **/
+#define log_set_journal(enable) logger.setJournal(enable)
+
+/**
+ * log_set_rate_limit() is to limit the messages of each call site
+ **/
+#define log_set_rate_limit(limit) logger.setRateLimit(limit)
+
+/**
+ * log_field() attaches a PCM_* journal field to the messages logged by the
+ *  current thread until the end of the enclosing block
+ **/
+#define LOG_FIELD_NAME(line) LOG_FIELD_NAME_(line)
+#define LOG_FIELD_NAME_(line) logField##line
+#define log_field(key, value)                                                  \
+    logging::LogField LOG_FIELD_NAME(__LINE__)(key, value)
+
+/**
+ * log_flush() waits until every message logged so far is written
+ **/
+#define log_flush() logger.flush()
+
+/**
+ * log_enabled() tells whether a message of the given level would be written.
+ *  Levels above LOG_MIN_LEVEL are constant false.
+ **/
+#define log_enabled(level)                                                     \
+    (getLogLevel(level) <= getLogLevel(LOG_MIN_LEVEL) &&                       \
+     logger.isEnabled(level, logging::ctrl::Category::LOG_CATEGORY))
+
+/**
+ * log_at() logs for the current call site. Arguments are only evaluated when
+ *  the level is enabled, and the call compiles away above LOG_MIN_LEVEL.
+ **/
+#define log_at(level, klass, fmt, ...)                                         \
+    do                                                                         \
+    {                                                                          \
+        if constexpr (getLogLevel(level) <= getLogLevel(LOG_MIN_LEVEL))        \
+        {                                                                      \
+            static constinit logging::LogSite logSite{                         \
+                __FILE__,                                                      \
+                __LINE__,                                                      \
+                __func__,                                                      \
+                fmt,                                                           \
+                logging::binary::siteId(__FILE__, __LINE__, fmt),              \
+                logging::ctrl::Category::LOG_CATEGORY};                        \
+            if (logger.isEnabled(level, logSite.category))                     \
+            {                                                                  \
+                logger.log(level, logSite, klass, ##__VA_ARGS__);              \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
 /**
  * Use any following log functions for debug logs.
  * log_* for using in class non-static member functions
  * logs_* for using in static and global functions
  **/
 #define log_err(fmt, ...)                                                      \
-    logger.log(LogLevel::error, "[%s][%s]: " fmt, typeid(*this).name(),        \
-               __func__, ##__VA_ARGS__)
+    log_at(LogLevel::error, typeid(*this).name(), fmt, ##__VA_ARGS__)
 #define log_wrn(fmt, ...)                                                      \
-    logger.log(LogLevel::warning, "[%s][%s]: " fmt, typeid(*this).name(),      \
-               __func__, ##__VA_ARGS__)
+    log_at(LogLevel::warning, typeid(*this).name(), fmt, ##__VA_ARGS__)
 #define log_dbg(fmt, ...)                                                      \
-    logger.log(LogLevel::debug, "[%s][%s]: " fmt, typeid(*this).name(),        \
-               __func__, ##__VA_ARGS__)
+    log_at(LogLevel::debug, typeid(*this).name(), fmt, ##__VA_ARGS__)
 #define log_info(fmt, ...)                                                     \
-    logger.log(LogLevel::information, "[%s][%s]: " fmt, typeid(*this).name(),  \
-               __func__, ##__VA_ARGS__)
+    log_at(LogLevel::information, typeid(*this).name(), fmt, ##__VA_ARGS__)
 #define log_info_raw(fmt, array, size)                                         \
-    logger.log_raw(LogLevel::information, fmt, array, size)
-
-#define logs_err(fmt, ...)                                                     \
-    logger.log(LogLevel::error, "[%s:%d][%s]: " fmt, __FILE__, __LINE__,       \
-               __func__, ##__VA_ARGS__)
+    do                                                                         \
+    {                                                                          \
+        if (log_enabled(LogLevel::information))                                \
+        {                                                                      \
+            logger.log_raw(LogLevel::information, fmt, array, size);           \
+        }                                                                      \
+    } while (0)
+
+#define logs_err(fmt, ...) log_at(LogLevel::error, nullptr, fmt, ##__VA_ARGS__)
 #define logs_wrn(fmt, ...)                                                     \
-    logger.log(LogLevel::warning, "[%s:%d][%s]: " fmt, __FILE__, __LINE__,     \
-               __func__, ##__VA_ARGS__)
-#define logs_dbg(fmt, ...)                                                     \
-    logger.log(LogLevel::debug, "[%s:%d][%s]: " fmt, __FILE__, __LINE__,       \
-               __func__, ##__VA_ARGS__)
+    log_at(LogLevel::warning, nullptr, fmt, ##__VA_ARGS__)
+#define logs_dbg(fmt, ...) log_at(LogLevel::debug, nullptr, fmt, ##__VA_ARGS__)
 #define logs_info(fmt, ...)                                                    \
-    logger.log(LogLevel::information, "[%s:%d][%s]: " fmt, __FILE__, __LINE__, \
-               __func__, ##__VA_ARGS__)
+    log_at(LogLevel::information, nullptr, fmt, ##__VA_ARGS__)
 #define logs_info_raw(fmt, array, size) log_info_raw(fmt, array, size)
+
+/**
+ * log_dbg_dump() and logs_dbg_dump() are for debug messages with costly
+ *  arguments, e.g. a whole configuration. They are only written to the
+ *  output, so the arguments are not built just for the flight recorder.
+ **/
+#define log_dbg_dump(fmt, ...)                                                 \
+    log_at(LogLevel::debug | LogLevel::outputonly, typeid(*this).name(), fmt,  \
+           ##__VA_ARGS__)
+#define logs_dbg_dump(fmt, ...)                                                \
+    log_at(LogLevel::debug | LogLevel::outputonly, nullptr, fmt, ##__VA_ARGS__)
@@ -0,0 +1,365 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Binary log records.
+ *
+ * In binary mode the logger writes, instead of a formatted line, the ID of
+ * the call site, the timestamps and the raw argument bytes. The first time
+ * a call site is used in a file, a site record with its file, line,
+ * function and format string is written before, so pcm-logdecode can turn
+ * the file back into text. Fixed size values are in host byte order,
+ * integers are LEB128 varints, signed ones zigzag encoded.
+ *
+ * File:    magic, then records
+ * Site:    'S' u32 id, var line, str file, str func, str format
+ * Message: 'M' u32 id, u8 level | flags, var sec, var nsec,
+ *          [var steady sec, var steady nsec,] u8 count, args
+ * Arg:     'i' zigzag var | 'u' var | 'd' double | 'p' var | 's' str
+ * str:     var length, bytes
+ * The class name of log_* messages is the first argument, flagged with
+ * classFlag. The steady time is only present with steadyFlag. With
+ * formattedFlag the last argument is the formatted message itself.
+ */
+
+#include <fmt/args.h>
+#include <fmt/format.h>
+#include <fmt/printf.h>
+#include <string.h>
+#include <time.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace logging
+{
+
+namespace binary
+{
+
+constexpr std::string_view magic{"PCMLOG\x01\n"};
+
+enum class Record : uint8_t
+{
+    site = 'S',
+    message = 'M',
+};
+
+enum class Arg : uint8_t
+{
+    signedInt = 'i',
+    unsignedInt = 'u',
+    floating = 'd',
+    pointer = 'p',
+    string = 's',
+};
+
+constexpr uint8_t classFlag = 0x80;
+constexpr uint8_t steadyFlag = 0x40;
+constexpr uint8_t formattedFlag = 0x20;
+constexpr uint8_t levelMask = 0x1F;
+
+/** FNV-1a hash of the call site, computed at compile time */
+constexpr uint32_t siteId(const char* file, int line, const char* format)
+{
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](uint8_t byte) {
+        hash ^= byte;
+        hash *= 16777619u;
+    };
+    for (auto p = file; *p != '\0'; p++)
+    {
+        mix(static_cast<uint8_t>(*p));
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        mix(static_cast<uint8_t>(static_cast<uint32_t>(line) >> (i * 8)));
+    }
+    for (auto p = format; *p != '\0'; p++)
+    {
+        mix(static_cast<uint8_t>(*p));
+    }
+    return hash;
+}
+
+template <typename T>
+void put(fmt::memory_buffer& buffer, T value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    auto bytes = reinterpret_cast<const char*>(&value);
+    buffer.append(bytes, bytes + sizeof(value));
+}
+
+inline void putVarint(fmt::memory_buffer& buffer, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+inline void putSigned(fmt::memory_buffer& buffer, int64_t value)
+{
+    putVarint(buffer, (static_cast<uint64_t>(value) << 1) ^
+                          static_cast<uint64_t>(value >> 63));
+}
+
+inline void putString(fmt::memory_buffer& buffer, std::string_view str)
+{
+    putVarint(buffer, str.size());
+    buffer.append(str.data(), str.data() + str.size());
+}
+
+/** Encode one printf argument with its type tag */
+template <typename T>
+void putArg(fmt::memory_buffer& buffer, const T& value)
+{
+    if constexpr (std::is_enum_v<T>)
+    {
+        putArg(buffer, static_cast<std::underlying_type_t<T>>(value));
+    }
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+    {
+        put(buffer, Arg::signedInt);
+        putSigned(buffer, value);
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+        put(buffer, Arg::unsignedInt);
+        putVarint(buffer, value);
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        put(buffer, Arg::floating);
+        put<double>(buffer, value);
+    }
+    else if constexpr (std::is_convertible_v<T, const char*>)
+    {
+        const char* str = value;
+        put(buffer, Arg::string);
+        putString(buffer, str != nullptr ? str : "(null)");
+    }
+    else if constexpr (std::is_convertible_v<T, std::string_view>)
+    {
+        put(buffer, Arg::string);
+        putString(buffer, value);
+    }
+    else if constexpr (std::is_pointer_v<T>)
+    {
+        put(buffer, Arg::pointer);
+        putVarint(buffer, reinterpret_cast<uintptr_t>(value));
+    }
+    else
+    {
+        static_assert(std::is_pointer_v<T>, "Unsupported log argument type");
+    }
+}
+
+/** Site record of a call site */
+inline void putSite(fmt::memory_buffer& buffer, uint32_t id,
+                    std::string_view file, int line, std::string_view func,
+                    std::string_view format)
+{
+    put(buffer, Record::site);
+    put<uint32_t>(buffer, id);
+    putVarint(buffer, static_cast<uint32_t>(line));
+    putString(buffer, file);
+    putString(buffer, func);
+    putString(buffer, format);
+}
+
+/**
+ * Message record of a call site. flags are the level and formattedFlag,
+ * classFlag and steadyFlag are set from klass and steady.
+ */
+template <typename... Args>
+void putMessage(fmt::memory_buffer& buffer, uint32_t id, uint8_t flags,
+                const struct timespec& ts, const struct timespec& steady,
+                const char* klass, const Args&... args)
+{
+    static_assert(sizeof...(Args) < 255, "Too many log arguments");
+    flags |= (klass != nullptr) ? classFlag : 0;
+    flags |= (steady.tv_sec >= 0) ? steadyFlag : 0;
+    put(buffer, Record::message);
+    put<uint32_t>(buffer, id);
+    put<uint8_t>(buffer, flags);
+    putVarint(buffer, ts.tv_sec);
+    putVarint(buffer, ts.tv_nsec);
+    if (steady.tv_sec >= 0)
+    {
+        putVarint(buffer, steady.tv_sec);
+        putVarint(buffer, steady.tv_nsec);
+    }
+    put<uint8_t>(buffer, sizeof...(Args) + (klass != nullptr ? 1 : 0));
+    if (klass != nullptr)
+    {
+        putArg(buffer, klass);
+    }
+    (putArg(buffer, args), ...);
+}
+
+/** Bounds checked reader over binary records */
+class Reader
+{
+  public:
+    explicit Reader(std::string_view data) : data(data) {}
+
+    bool atEnd() const
+    {
+        return pos == data.size();
+    }
+
+    size_t offset() const
+    {
+        return pos;
+    }
+
+    bool skipMagic()
+    {
+        if (data.substr(pos, magic.size()) != magic)
+        {
+            return false;
+        }
+        pos += magic.size();
+        return true;
+    }
+
+    template <typename T>
+    T get()
+    {
+        T value;
+        memcpy(&value, take(sizeof(value)).data(), sizeof(value));
+        return value;
+    }
+
+    uint64_t getVarint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            auto byte = get<uint8_t>();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+            {
+                return value;
+            }
+        }
+        throw std::runtime_error("bad varint");
+    }
+
+    int64_t getSigned()
+    {
+        auto value = getVarint();
+        return static_cast<int64_t>(value >> 1) ^
+               -static_cast<int64_t>(value & 1);
+    }
+
+    std::string_view getString()
+    {
+        return take(getVarint());
+    }
+
+    std::string_view take(size_t size)
+    {
+        if (data.size() - pos < size)
+        {
+            throw std::runtime_error("truncated record");
+        }
+        auto bytes = data.substr(pos, size);
+        pos += size;
+        return bytes;
+    }
+
+  private:
+    std::string_view data;
+    size_t pos = 0;
+};
+
+/** Decoded message record */
+struct Message
+{
+    uint32_t id = 0;
+    uint8_t flags = 0;
+    struct timespec ts = {0, 0};
+    struct timespec steady = {-1, 0};
+    std::string klass;
+    /** The formatted message with formattedFlag */
+    std::string text;
+    fmt::dynamic_format_arg_store<fmt::printf_context> args;
+};
+
+/** Read a message record, the record type is already consumed */
+inline void readMessage(Reader& reader, Message& message)
+{
+    message.id = reader.get<uint32_t>();
+    message.flags = reader.get<uint8_t>();
+    message.ts.tv_sec = reader.getVarint();
+    message.ts.tv_nsec = reader.getVarint();
+    if (message.flags & steadyFlag)
+    {
+        message.steady.tv_sec = reader.getVarint();
+        message.steady.tv_nsec = reader.getVarint();
+    }
+
+    auto count = reader.get<uint8_t>();
+    for (int i = 0; i < count; i++)
+    {
+        switch (static_cast<Arg>(reader.get<uint8_t>()))
+        {
+            case Arg::signedInt:
+                message.args.push_back(reader.getSigned());
+                break;
+            case Arg::unsignedInt:
+                message.args.push_back(reader.getVarint());
+                break;
+            case Arg::floating:
+                message.args.push_back(reader.get<double>());
+                break;
+            case Arg::pointer:
+                message.args.push_back(
+                    reinterpret_cast<const void*>(reader.getVarint()));
+                break;
+            case Arg::string:
+                if (i == 0 && (message.flags & classFlag))
+                {
+                    message.klass = reader.getString();
+                }
+                else if (i == count - 1 && (message.flags & formattedFlag))
+                {
+                    message.text = reader.getString();
+                }
+                else
+                {
+                    message.args.push_back(std::string(reader.getString()));
+                }
+                break;
+            default:
+                throw std::runtime_error("unknown argument type");
+        }
+    }
+}
+
+} // namespace binary
+
+} // namespace logging
@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Log control block - the log levels of pcmd in shared memory
+ *
+ * Each log category has its own level, stored as an atomic in a
+ * versioned block so the levels can be changed by pcm-logctl while pcmd
+ * runs. Log calls check the level of their category with a single relaxed
+ * load.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+namespace logging
+{
+
+namespace ctrl
+{
+
+constexpr char MAGIC[4] = {'P', 'C', 'M', 'L'};
+constexpr uint32_t VERSION = 1;
+
+/**
+ * Log categories, a translation unit selects its category with
+ * #define LOG_CATEGORY x
+ * before including log.hpp
+ */
+enum class Category : uint8_t
+{
+    main,
+    dbus,
+    config,
+    checks,
+    actions,
+};
+
+constexpr std::array<std::string_view, 5> categoryNames = {
+    "main", "dbus", "config", "checks", "actions"};
+
+/** Room for categories added later without changing the layout */
+constexpr size_t MAX_CATEGORIES = 16;
+
+struct Block
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t categoryCount;
+    uint32_t reserved;
+    std::atomic<int32_t> levels[MAX_CATEGORIES];
+};
+
+static_assert(std::atomic<int32_t>::is_always_lock_free);
+
+inline std::optional<Category> categoryFromName(std::string_view name)
+{
+    for (size_t i = 0; i < categoryNames.size(); i++)
+    {
+        if (categoryNames[i] == name)
+        {
+            return static_cast<Category>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+inline bool isValid(const Block& block)
+{
+    return memcmp(block.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+           block.version == VERSION &&
+           block.categoryCount <= MAX_CATEGORIES;
+}
+
+/** Fill a new block with every level set to level */
+inline void initBlock(Block& block, int level)
+{
+    for (auto& categoryLevel : block.levels)
+    {
+        categoryLevel.store(level, std::memory_order_relaxed);
+    }
+    block.categoryCount = categoryNames.size();
+    block.version = VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(block.magic, MAGIC, sizeof(MAGIC));
+}
+
+/** Map an existing control block for changing levels, nullptr if none */
+inline Block* openBlock(const char* name)
+{
+    int fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    void* addr = mmap(nullptr, sizeof(Block), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    auto block = static_cast<Block*>(addr);
+    if (!isValid(*block))
+    {
+        munmap(addr, sizeof(Block));
+        return nullptr;
+    }
+    return block;
+}
+
+inline void closeBlock(Block* block)
+{
+    munmap(block, sizeof(Block));
+}
+
+} // namespace ctrl
+
+} // namespace logging
@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Flight recorder - the last messages of pcmd kept in shared memory
+ *
+ * Messages up to the flight level are stored as binary records (see
+ * log_binary.hpp) in a ring in /dev/shm, independently of the log level,
+ * so they survive a crash or a restart of pcmd and can be read with
+ * pcm-dump. The call sites are kept in a table next to the ring, so the
+ * block can be decoded by another process. Messages which do not fit in a
+ * slot are stored formatted and truncated.
+ *
+ * The block is started over when it was written by another build of the
+ * binary or of libpcm, whose call sites would otherwise fill the table over
+ * upgrades.
+ */
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace logging
+{
+
+namespace flight
+{
+
+constexpr auto SHM_NAME = "nvidia_pcm_flight";
+constexpr char MAGIC[4] = {'P', 'C', 'M', 'F'};
+constexpr uint32_t VERSION = 2;
+constexpr size_t SLOT_COUNT = 2048;
+constexpr size_t SITE_COUNT = 1024;
+
+/** Call site, id is 0 while the entry is free */
+struct Site
+{
+    std::atomic<uint32_t> id;
+    std::atomic<uint32_t> ready;
+    uint32_t line;
+    char file[44];
+    char func[40];
+    char format[160];
+};
+
+/**
+ * One message record. seq is odd while a writer fills the slot and
+ * 2 * (position + 1) once the record at that ring position is complete.
+ */
+struct Slot
+{
+    std::atomic<uint64_t> seq;
+    uint16_t size;
+    char data[246];
+};
+
+struct Block
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t siteCount;
+    /** Process which wrote last */
+    int32_t pid;
+    uint32_t reserved;
+    /** Hash of the build IDs of the writer, binary and libpcm */
+    uint64_t build;
+    /** Ring positions handed out so far */
+    std::atomic<uint64_t> head;
+    Site sites[SITE_COUNT];
+    Slot slots[SLOT_COUNT];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(sizeof(Site) == 256);
+static_assert(sizeof(Slot) == 256);
+
+/**
+ * Writer side, maps the shared memory block and creates it if needed.
+ * Records of a previous run are kept.
+ */
+class Recorder
+{
+  public:
+    /** Largest binary record stored as is */
+    static constexpr size_t maxRecord = sizeof(Slot::data);
+
+    Recorder();
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    /** Store a record of the given call site, lock-free */
+    void record(uint32_t id, const char* file, int line, const char* func,
+                const char* format, std::string_view record);
+
+    const Block& getBlock() const
+    {
+        return *block;
+    }
+
+  private:
+    void defineSite(uint32_t id, const char* file, int line,
+                    const char* func, const char* format);
+
+    Block* block = nullptr;
+};
+
+/** Map the flight recorder of pcmd read-only, nullptr if there is none */
+const Block* openBlock();
+
+void closeBlock(const Block* block);
+
+/**
+ * Append the recorded messages as text lines, oldest first, at most last
+ * ones if not 0. Returns the number of messages.
+ */
+size_t dump(const Block& block, fmt::memory_buffer& out, size_t last = 0);
+
+} // namespace flight
+
+} // namespace logging
@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Tracing - timed spans exported as a Chrome/Perfetto trace
+ *
+ * A span is a scope timed with CLOCK_MONOTONIC, opened with trace_span().
+ * Finished spans are appended to a buffer owned by the thread, without any
+ * lock, so concurrent evaluations can be traced. Nested spans of a thread
+ * are shown as a stack by the viewers. When tracing was started with
+ * trace::start(), all the buffers are written as trace JSON (traceEvents)
+ * by trace::stop(), to be opened with ui.perfetto.dev or chrome://tracing.
+ *
+ * Tracing costs one relaxed load per span while it is not started.
+ */
+
+#include <time.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace logging
+{
+
+namespace trace
+{
+
+/** Set while tracing is started */
+extern std::atomic<bool> active;
+
+inline bool enabled()
+{
+    return active.load(std::memory_order_relaxed);
+}
+
+/** CLOCK_MONOTONIC in ns */
+inline int64_t now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+/**
+ * Append a finished span to the buffer of the calling thread. category and
+ * name must be string literals, detail is shown as an argument.
+ */
+void record(const char* category, const char* name, int64_t begin,
+            int64_t end, std::string_view detail = {});
+
+/**
+ * Start tracing, the trace is written to file by stop().
+ * Throws if the file cannot be written.
+ */
+void start(const std::string& file);
+
+/**
+ * Stop tracing and write the spans recorded so far. Returns false if the
+ * trace could not be written.
+ */
+bool stop();
+
+/**
+ * Timed scope, see trace_span(). The detail parts are joined with spaces,
+ * only while tracing.
+ */
+class Span
+{
+  public:
+    template <typename... Parts>
+    explicit Span(const char* category, const char* name,
+                  const Parts&... parts) :
+        category(category), name(name)
+    {
+        if (enabled())
+        {
+            ((detail.append(detail.empty() ? "" : " ")
+                  .append(std::string_view(parts))),
+             ...);
+            begin = now();
+        }
+    }
+
+    ~Span()
+    {
+        if (begin != 0)
+        {
+            record(category, name, begin, now(), detail);
+        }
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+  private:
+    const char* category;
+    const char* name;
+    std::string detail;
+    int64_t begin = 0;
+};
+
+} // namespace trace
+
+} // namespace logging
+
+/**
+ * trace_span() times the rest of the enclosing block,
+ *  e.g. trace_span("dbus", "Get", objectPath, property)
+ **/
+#define TRACE_SPAN_NAME(line) TRACE_SPAN_NAME_(line)
+#define TRACE_SPAN_NAME_(line) traceSpan##line
+#define trace_span(category, name, ...)                                        \
+    logging::trace::Span TRACE_SPAN_NAME(__LINE__)(category, name,             \
+                                                   ##__VA_ARGS__)
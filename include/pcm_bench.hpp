@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Benchmark mode - the load and match pipeline of pcmd run in a loop.
+ *
+ * Every iteration loads the platform configurations of the data directory
+ * and evaluates them, as pcmd does at boot, and no action is performed.
+ * Cold iterations drop the page cache first, so the files are read from the
+ * storage again; warm ones follow an untimed iteration. The D-Bus services
+ * keep their own caches in both modes.
+ **/
+
+#include "dbus_backend.hpp"
+#include "pcm_report.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace pcm_bench
+{
+
+enum class Mode
+{
+    cold,
+    warm
+};
+
+/** @brief Parse "cold" or "warm"
+ *
+ * @throw std::invalid_argument for any other name
+ */
+Mode modeFromName(const std::string& name);
+
+/** @brief Distribution of one quantity over the iterations */
+struct Distribution
+{
+    int64_t min = 0;
+    int64_t median = 0;
+    int64_t p95 = 0;
+    int64_t max = 0;
+};
+
+struct Result
+{
+    size_t iterations = 0;
+    Mode mode = Mode::warm;
+
+    /** @brief Name of the winner of the last iteration */
+    std::string winner;
+
+    /** @brief Latency of a whole iteration, in microseconds */
+    Distribution total;
+
+    /** @brief Latency of each pcm_report phase, in microseconds */
+    std::array<Distribution, static_cast<size_t>(pcm_report::Phase::count)>
+        phases;
+
+    /** @brief D-Bus calls and cache hits of each evaluation */
+    Distribution dbusCalls;
+    Distribution cacheHits;
+};
+
+/**
+ * @brief Run the pipeline the given number of times
+ *
+ * The phase latencies are taken from pcm_report, which is enabled for the
+ * run.
+ *
+ * @param[in]  dataDir - Data directory, e.g. /usr/share/nvidia-pcm/
+ * @param[in]  backend - Source of the property values
+ * @param[in]  iterations - Number of timed iterations, at least 1
+ * @param[in]  mode - Cold or warm iterations
+ *
+ * @throw std::runtime_error if the caches cannot be dropped for the cold
+ *        mode, e.g. when not run as root
+ */
+Result run(const std::string& dataDir, dbus::Backend& backend,
+           size_t iterations, Mode mode);
+
+/** @brief Human readable table of the distributions, ending with a new line
+ */
+std::string toTable(const Result& result);
+
+} // namespace pcm_bench
@@ -0,0 +1,240 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Metrics of pcmd, exported as a textfile for node-exporter style
+ * collection.
+ *
+ * Counters, gauges and fixed-bucket histograms are plain atomics updated
+ * with relaxed increments, so they can be updated from any thread on hot
+ * paths. Metrics are defined once as globals and link themselves into the
+ * registry when constructed; write() renders all of them in the Prometheus
+ * text format and replaces the file atomically.
+ *
+ * @code
+ *   pcm_metrics::evaluations.inc();
+ *   pcm_metrics::dbusCalls.inc(service);
+ *   pcm_metrics::write("/var/lib/node_exporter/textfile/pcm.prom");
+ * @endcode
+ **/
+
+#include <fmt/format.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+namespace pcm_metrics
+{
+
+/** @brief Base of all metrics, linked into the registry */
+class Metric
+{
+  public:
+    Metric(const char* name, const char* help, const char* type);
+    virtual ~Metric() = default;
+
+    Metric(const Metric&) = delete;
+    Metric& operator=(const Metric&) = delete;
+
+    /** @brief Append the samples, after the HELP and TYPE lines */
+    virtual void writeSamples(fmt::memory_buffer& out) const = 0;
+
+    const char* const name;
+    const char* const help;
+    const char* const type;
+    const Metric* next = nullptr;
+};
+
+class Counter : public Metric
+{
+  public:
+    Counter(const char* name, const char* help) :
+        Metric(name, help, "counter")
+    {}
+
+    void inc(uint64_t n = 1)
+    {
+        value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t get() const
+    {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    void writeSamples(fmt::memory_buffer& out) const override;
+
+  private:
+    std::atomic<uint64_t> value{0};
+};
+
+class Gauge : public Metric
+{
+  public:
+    Gauge(const char* name, const char* help) : Metric(name, help, "gauge")
+    {}
+
+    void set(int64_t v)
+    {
+        value.store(v, std::memory_order_relaxed);
+    }
+
+    int64_t get() const
+    {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    void writeSamples(fmt::memory_buffer& out) const override;
+
+  private:
+    std::atomic<int64_t> value{0};
+};
+
+/**
+ * @brief Counter with one label. The first maxValues label values get
+ *        their own counter, the next ones are counted as "other".
+ */
+class LabeledCounter : public Metric
+{
+  public:
+    static constexpr size_t maxValues = 32;
+    static constexpr size_t maxValueSize = 96;
+
+    LabeledCounter(const char* name, const char* help, const char* label) :
+        Metric(name, help, "counter"), label(label)
+    {}
+
+    /** @brief Counter of one label value, looked up once by handle() */
+    class Handle
+    {
+      public:
+        void inc(uint64_t n = 1)
+        {
+            count->fetch_add(n, std::memory_order_relaxed);
+        }
+
+      private:
+        friend class LabeledCounter;
+        explicit Handle(std::atomic<uint64_t>& count) : count(&count) {}
+
+        std::atomic<uint64_t>* count;
+    };
+
+    void inc(std::string_view value, uint64_t n = 1)
+    {
+        slot(value).count.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /** @brief Handle of the value, for call sites counting it often */
+    Handle handle(std::string_view value)
+    {
+        return Handle(slot(value).count);
+    }
+
+    void writeSamples(fmt::memory_buffer& out) const override;
+
+  private:
+    /** @brief size is 0 while free, SIZE_MAX while being filled */
+    struct Slot
+    {
+        std::atomic<size_t> size{0};
+        char value[maxValueSize];
+        std::atomic<uint64_t> count{0};
+    };
+
+    Slot& slot(std::string_view value);
+
+    const char* const label;
+    std::array<Slot, maxValues> slots;
+    Slot other;
+};
+
+/**
+ * @brief Histogram of durations, with fixed bucket bounds in microseconds
+ *        and samples in seconds.
+ */
+class Histogram : public Metric
+{
+  public:
+    static constexpr size_t maxBuckets = 16;
+
+    Histogram(const char* name, const char* help,
+              std::initializer_list<uint64_t> boundsUs);
+
+    void observe(uint64_t us)
+    {
+        size_t i = 0;
+        while (i < boundCount && us > bounds[i])
+        {
+            i++;
+        }
+        buckets[i].fetch_add(1, std::memory_order_relaxed);
+        sumUs.fetch_add(us, std::memory_order_relaxed);
+    }
+
+    void writeSamples(fmt::memory_buffer& out) const override;
+
+  private:
+    std::array<uint64_t, maxBuckets> bounds{};
+    size_t boundCount = 0;
+    /** @brief Not cumulative, the last one is +Inf */
+    std::array<std::atomic<uint64_t>, maxBuckets + 1> buckets{};
+    std::atomic<uint64_t> sumUs{0};
+};
+
+/** @brief Calls and failures of D-Bus methods, per destination service */
+extern LabeledCounter dbusCalls;
+extern LabeledCounter dbusFailures;
+extern Histogram dbusLatency;
+
+/** @brief Evaluations of the platform configurations and their latency */
+extern Counter evaluations;
+extern Histogram detectionLatency;
+extern Counter cacheHits;
+extern Counter cacheMisses;
+/** @brief Evaluations where no platform configuration matched, and runs
+ *         falling back to the default one as the matched one failed */
+extern Counter defaultConfigUsed;
+
+/** @brief Checks per result: passed, failed or error */
+extern LabeledCounter checks;
+extern LabeledCounter::Handle checksPassed;
+extern LabeledCounter::Handle checksFailed;
+extern LabeledCounter::Handle checksError;
+/** @brief Actions per result: applied or failed */
+extern LabeledCounter actions;
+extern LabeledCounter::Handle actionsApplied;
+extern LabeledCounter::Handle actionsFailed;
+
+extern Gauge configFiles;
+
+/** @brief Render all the metrics */
+void render(fmt::memory_buffer& out);
+
+/** @brief Write all the metrics to file, with utils::writeFileAtomically()
+ *
+ * @return false if the file could not be written
+ */
+bool write(const std::string& file);
+
+} // namespace pcm_metrics
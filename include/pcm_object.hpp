@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "dbus_accessor.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pcm_object
+{
+
+/** @brief Outcome of one platform detection run as published on D-Bus */
+struct Result
+{
+    /** @brief Name of the matched platform configuration */
+    std::string name;
+
+    /** @brief File the matched platform configuration was loaded from */
+    std::string configFile;
+
+    /** @brief Time spent evaluating the platform configurations, in us */
+    uint64_t evaluationDuration = 0;
+
+    /** @brief Number of D-Bus calls issued during the evaluation */
+    uint64_t dbusCallCount = 0;
+
+    /** @brief Descriptions of the checks that decided the match */
+    std::vector<std::string> matchedChecks;
+};
+
+/**
+ * @brief Hosts the detection result as a D-Bus object
+ *
+ * The object lives at dbus::object_path::pcm and implements
+ * dbus::interface::pcmResult with read-only properties Name, ConfigFile,
+ * EvaluationDuration, DBusCallCount and MatchedChecks. PropertiesChanged is
+ * emitted for every property modified through update(), so consumers can
+ * subscribe instead of polling the EnvironmentFile.
+ */
+class ResultObject
+{
+  public:
+    ResultObject(sdbusplus::bus::bus& bus, const char* path);
+    ResultObject(const ResultObject&) = delete;
+    ResultObject& operator=(const ResultObject&) = delete;
+
+    /** @brief Replace the published result, emitting PropertiesChanged for
+     *  the properties that differ from the previous one.
+     *
+     * @param[in]  result - The new result
+     */
+    void update(const Result& result);
+
+    /** @brief Currently published result */
+    const Result& get() const
+    {
+        return result;
+    }
+
+  private:
+    static int getName(sd_bus* bus, const char* path, const char* intf,
+                       const char* property, sd_bus_message* reply,
+                       void* context, sd_bus_error* error);
+    static int getConfigFile(sd_bus* bus, const char* path, const char* intf,
+                             const char* property, sd_bus_message* reply,
+                             void* context, sd_bus_error* error);
+    static int getEvaluationDuration(sd_bus* bus, const char* path,
+                                     const char* intf, const char* property,
+                                     sd_bus_message* reply, void* context,
+                                     sd_bus_error* error);
+    static int getDBusCallCount(sd_bus* bus, const char* path,
+                                const char* intf, const char* property,
+                                sd_bus_message* reply, void* context,
+                                sd_bus_error* error);
+    static int getMatchedChecks(sd_bus* bus, const char* path,
+                                const char* intf, const char* property,
+                                sd_bus_message* reply, void* context,
+                                sd_bus_error* error);
+
+    static const sdbusplus::vtable::vtable_t vtable[];
+
+    Result result;
+    sdbusplus::server::interface_t intf;
+};
+
+} // namespace pcm_object
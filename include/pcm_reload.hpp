@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "platform_matcher.hpp"
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/io.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <set>
+#include <string>
+
+namespace pcm_reload
+{
+
+/**
+ * @brief Reloads the platform configuration files when they change
+ *
+ * An inotify watch is set on the platform configuration directory and on the
+ * data directory, for the default configuration file. Changes are collected
+ * until no new one arrives for the debounce period, so a burst of writes
+ * during a firmware update counts as one change. Only the changed files are
+ * parsed again, see platform_matcher::PlatformMatcher::reload().
+ */
+class Reloader
+{
+  public:
+    /** @brief Called after the matcher swapped in a new ConfigSet */
+    using Callback = std::function<void()>;
+
+    /**
+     * @param[in]  event - Event loop watching the inotify descriptor
+     * @param[in]  matcher - Matcher to reload, must outlive the reloader
+     * @param[in]  debounce - Quiet period closing a burst of changes
+     * @param[in]  callback - Called when the ConfigSet changed
+     */
+    Reloader(sdeventplus::Event& event,
+             platform_matcher::PlatformMatcher& matcher,
+             std::chrono::milliseconds debounce, Callback callback);
+    Reloader(const Reloader&) = delete;
+    Reloader& operator=(const Reloader&) = delete;
+    ~Reloader();
+
+  private:
+    void onEvent();
+    void onQuiet();
+
+    platform_matcher::PlatformMatcher& matcher;
+    std::chrono::milliseconds debounce;
+    Callback callback;
+
+    int fd;
+    int confWd;
+    int dataWd;
+    std::set<std::string> pending;
+
+    std::optional<sdeventplus::source::IO> io;
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> timer;
+};
+
+} // namespace pcm_reload
@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Run report - where the time and resources of a pcmd run went.
+ *
+ * The main flow is split in phases, each one entered with a Scope. A phase
+ * accumulates its monotonic duration, CPU time, page faults and the peak
+ * RSS seen at its end, read with getrusage(RUSAGE_THREAD). Phases are
+ * exclusive: a nested phase pauses the enclosing one, e.g. the D-Bus
+ * property reads are not counted in the matching, so the phases add up to
+ * the time spent in the flow. Entering or leaving a phase costs two
+ * syscalls, the totals are atomics shared by all the threads.
+ *
+ * @code
+ *   {
+ *       pcm_report::Scope phase(pcm_report::Phase::load);
+ *       ...
+ *   }
+ *   pcm_report::write("/run/nvidia-pcm-report.json");
+ * @endcode
+ **/
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace pcm_report
+{
+
+enum class Phase : size_t
+{
+    args,       // Command line parsing
+    scan,       // Listing of the platform configuration directory
+    load,       // Parsing of the platform configuration files
+    mapper,     // Object mapper queries
+    properties, // D-Bus property reads
+    match,      // Evaluation of the checks, without the D-Bus calls
+    actions,    // Environment file, shared memory and systemd export
+    count
+};
+
+constexpr std::array<const char*, static_cast<size_t>(Phase::count)>
+    phaseNames = {"args",       "scan",  "load",   "mapper",
+                  "properties", "match", "actions"};
+
+/** @brief Collection is on by default, it can be turned off */
+void setEnabled(bool enable);
+
+bool isEnabled();
+
+/** @brief Accounts the rest of the enclosing block to a phase */
+class Scope
+{
+  public:
+    explicit Scope(Phase phase);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    /** @brief Resource usage of the calling thread */
+    struct Sample
+    {
+        int64_t wall;
+        int64_t cpu;
+        int64_t minorFaults;
+        int64_t majorFaults;
+        int64_t maxRss;
+    };
+
+  private:
+    /** @brief Add the usage since start to the phase */
+    void charge(const Sample& now);
+
+    Phase phase;
+    Scope* parent = nullptr;
+    bool active = false;
+    Sample start;
+};
+
+/** @brief Monotonic time accounted to each phase so far, in microseconds */
+std::array<int64_t, static_cast<size_t>(Phase::count)> wallTimes();
+
+/** @brief Write the report as JSON, with utils::writeFileAtomically()
+ *
+ * @return false if the file could not be written
+ */
+bool write(const std::string& file);
+
+} // namespace pcm_report
@@ -0,0 +1,274 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Shared-memory published platform detection result.
+ *
+ * pcmd publishes its decision into a small versioned block, updated under a
+ * seqlock. Co-located daemons read it with a few loads, without file I/O or
+ * a D-Bus round-trip:
+ *
+ * @code
+ *   pcm_shm::Reader reader;
+ *   pcm_shm::Snapshot snapshot;
+ *   if (reader.open() &&
+ *       reader.read(snapshot) == pcm_shm::ReadStatus::ok &&
+ *       snapshot.status != pcm_shm::Status::none)
+ *   {
+ *       // snapshot.name, snapshot.env[0 .. snapshot.envCount)
+ *   }
+ * @endcode
+ *
+ * Readers on hot paths can cache the snapshot and only copy it again when
+ * Reader::generation() changes.
+ *
+ * Only this header is needed by readers, the Writer is part of pcmlib.
+ **/
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace pcm_shm
+{
+
+/** @brief Name of the shared-memory object, as passed to shm_open */
+constexpr auto SHM_NAME = "nvidia_pcm_result";
+
+/** @brief "PCMR" */
+constexpr uint32_t SHM_MAGIC = 0x50434d52;
+/** @brief Bumped on every incompatible change of Block */
+constexpr uint32_t SHM_VERSION = 1;
+
+constexpr size_t NAME_SIZE = 128;
+constexpr size_t KEY_SIZE = 64;
+constexpr size_t VALUE_SIZE = 256;
+constexpr size_t MAX_ENV = 32;
+/** @brief Attempts of Reader::read() before it yields the CPU to the
+ *         writer, and time after which it gives up */
+constexpr unsigned READ_SPINS = 100;
+constexpr std::chrono::milliseconds READ_TIMEOUT{50};
+
+enum class Status : int32_t
+{
+    none = 0,      // Nothing published yet
+    matched = 1,   // A platform configuration matched the platform
+    defaulted = 2, // No match, the default configuration was applied
+    failed = 3,    // Detection failed, the environment may be incomplete
+};
+
+struct EnvEntry
+{
+    char key[KEY_SIZE];
+    char value[VALUE_SIZE];
+};
+
+/** @brief Outcome of Reader::read() */
+enum class ReadStatus
+{
+    ok,       // The snapshot was copied
+    unmapped, // The block is not mapped, see Reader::open()
+    busy,     // An update did not complete within READ_TIMEOUT, e.g. as the
+              // writer died in the middle of it. Retry later.
+};
+
+/** @brief Plain copy of the published result */
+struct Snapshot
+{
+    uint32_t generation;
+    Status status;
+    uint32_t envCount;
+    char name[NAME_SIZE];
+    EnvEntry env[MAX_ENV];
+};
+
+/** @brief Layout of the shared-memory object */
+struct Block
+{
+    uint32_t magic;
+    uint32_t version;
+    /** @brief Seqlock sequence, odd while the writer updates @c data */
+    std::atomic<uint32_t> sequence;
+    /** @brief Mirrors data.generation, readable with a single load */
+    std::atomic<uint32_t> generation;
+    Snapshot data;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Seqlock needs lock-free 32 bits atomics");
+
+class Reader
+{
+  public:
+    Reader() = default;
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    ~Reader()
+    {
+        if (block != nullptr)
+        {
+            munmap(block, sizeof(Block));
+        }
+    }
+
+    /** @brief Map the block read-only, may be retried until pcmd created it
+     *
+     * @return true when mapped and compatible with this header
+     */
+    bool open(const char* name = SHM_NAME)
+    {
+        if (block != nullptr)
+        {
+            return true;
+        }
+
+        int fd = shm_open(name, O_RDONLY, 0);
+        if (fd == -1)
+        {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) == -1 ||
+            static_cast<size_t>(st.st_size) < sizeof(Block))
+        {
+            close(fd);
+            return false;
+        }
+
+        void* addr = mmap(nullptr, sizeof(Block), PROT_READ, MAP_SHARED, fd,
+                          0);
+        close(fd);
+        if (addr == MAP_FAILED)
+        {
+            return false;
+        }
+
+        block = static_cast<Block*>(addr);
+        if (block->magic != SHM_MAGIC || block->version != SHM_VERSION)
+        {
+            munmap(block, sizeof(Block));
+            block = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    /** @brief Generation of the published result, 0 if none */
+    uint32_t generation() const
+    {
+        return block ? block->generation.load(std::memory_order_acquire) : 0;
+    }
+
+    /** @brief Copy a consistent snapshot of the published result
+     *
+     * @param[out] snapshot - Filled in with the result
+     *
+     * @return ReadStatus::ok once copied. A writer which died in the
+     *         middle of an update leaves the block busy until pcmd starts
+     *         again and repairs it.
+     */
+    ReadStatus read(Snapshot& snapshot) const
+    {
+        if (block == nullptr)
+        {
+            return ReadStatus::unmapped;
+        }
+
+        std::chrono::steady_clock::time_point deadline;
+        for (unsigned attempt = 0;; attempt++)
+        {
+            auto begin = block->sequence.load(std::memory_order_acquire);
+            if ((begin & 1) == 0)
+            {
+                std::memcpy(&snapshot, &block->data, sizeof(snapshot));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (block->sequence.load(std::memory_order_relaxed) == begin)
+                {
+                    return ReadStatus::ok;
+                }
+            }
+
+            // Writer in progress, let it run once spinning did not help
+            if (attempt < READ_SPINS)
+            {
+                continue;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (attempt == READ_SPINS)
+            {
+                deadline = now + READ_TIMEOUT;
+            }
+            else if (now >= deadline)
+            {
+                return ReadStatus::busy;
+            }
+            sched_yield();
+        }
+    }
+
+  private:
+    Block* block = nullptr;
+};
+
+/**
+ * @brief Publishes the result into the shared-memory block
+ *
+ * There must be a single writer, pcmd. The generation keeps counting across
+ * restarts of the writer for as long as the block exists.
+ */
+class Writer
+{
+  public:
+    explicit Writer(const char* name = SHM_NAME);
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    ~Writer();
+
+    /** @brief Publish a new result under the seqlock
+     *
+     * @param[in]  name - Name of the platform configuration
+     * @param[in]  status - Outcome of the detection
+     * @param[in]  variables - "KEY=VALUE" environment assignments, the
+     *                          ones with a key or a value too long for an
+     *                          EnvEntry are left out
+     *
+     * @return the new generation
+     *
+     * @throw std::runtime_error if the name does not fit in the block
+     */
+    uint32_t publish(const std::string& name, Status status,
+                     const std::vector<std::string>& variables);
+
+  private:
+    int smfd;
+    Block* block;
+};
+
+} // namespace pcm_shm
@@ -0,0 +1,120 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "dbus_backend.hpp"
+#include "platform_matcher.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pcm_watch
+{
+
+/**
+ * @brief Re-evaluates the platform configurations on inventory changes
+ *
+ * Every check is evaluated once at start and its outcome is cached. The
+ * watcher then subscribes to PropertiesChanged for every interface used by a
+ * check, and to InterfacesAdded/InterfacesRemoved. A signal only marks the
+ * checks depending on its (path, interface, property) as dirty. Dirty checks
+ * are evaluated again in a deferred event, so a burst of signals costs one
+ * re-evaluation, and the configs are decided again from the cached outcomes.
+ * The callback is called only when the winner changes.
+ */
+class Watcher
+{
+  public:
+    /** @brief Called with the new result when the winner changes */
+    using Callback = std::function<void(const platform_matcher::MatchResult&)>;
+
+    /**
+     * @param[in]  bus - Bus the signals are received on, attached to event
+     * @param[in]  event - Event loop running the deferred re-evaluation
+     * @param[in]  matcher - Platform configurations, must outlive the watcher
+     * @param[in]  backend - Source of the property values
+     * @param[in]  winner - Name of the currently applied config
+     * @param[in]  callback - Called when the winner changes
+     */
+    Watcher(sdbusplus::bus::bus& bus, sdeventplus::Event& event,
+            const platform_matcher::PlatformMatcher& matcher,
+            dbus::Backend& backend, const std::string& winner,
+            Callback callback);
+    Watcher(const Watcher&) = delete;
+    Watcher& operator=(const Watcher&) = delete;
+
+    /** @brief Result decided from the cached check outcomes */
+    platform_matcher::MatchResult getResult() const;
+
+    /** @brief Switch to the current ConfigSet of the matcher
+     *
+     * Cached outcomes are kept for configs shared with the previous set,
+     * only the checks of new or changed configs are evaluated. The winner is
+     * decided again only if a change could affect it: a config evaluated
+     * before the winner, the winner itself, or any config when the default
+     * one is applied.
+     */
+    void reload();
+
+  private:
+    /** @brief (config index, check index) */
+    using CheckId = std::pair<size_t, size_t>;
+
+    void buildDependencies();
+    void evaluateAll();
+    void subscribe();
+    void markDirty(const std::string& path, const std::string& interface,
+                   const std::set<std::string>* properties);
+    void reevaluate();
+
+    void onPropertiesChanged(sdbusplus::message::message& msg);
+    void onInterfacesAdded(sdbusplus::message::message& msg);
+    void onInterfacesRemoved(sdbusplus::message::message& msg);
+
+    sdbusplus::bus::bus& bus;
+    const platform_matcher::PlatformMatcher& matcher;
+    dbus::Backend& backend;
+    std::string winner;
+    Callback callback;
+
+    /** @brief ConfigSet the cached outcomes belong to */
+    std::shared_ptr<const platform_matcher::ConfigSet> configSet;
+    /** @brief Config applied for the current winner */
+    std::shared_ptr<const platform_config::Config> winnerConfig;
+
+    /** @brief Checks depending on each interface */
+    std::map<std::string, std::vector<CheckId>> dependencies;
+    /** @brief Cached outcome of every check, [config][check] */
+    std::vector<std::vector<platform_checks::CheckResult>> results;
+    std::set<CheckId> dirty;
+
+    std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches;
+    sdeventplus::source::Defer deferred;
+};
+
+} // namespace pcm_watch
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "constants.hpp"
+
 #include <iostream>
 #include <map>
 #include <string>
@@ -32,8 +34,15 @@ struct Actions_t
     std::vector<std::string> variables;
 
   public:
-    /** @brief Perform the actions present in the struct */
-    int performActions(const std::string& name, bool& fileCreated);
+    /** @brief Perform the actions present in the struct
+     *
+     * @param[in]  name - Name of the platform config, written as NAME
+     * @param[in,out]  fileCreated - Whether envPath was already truncated
+     * @param[in]  envPath - Environment file to write
+     */
+    int performActions(
+        const std::string& name, bool& fileCreated,
+        const std::string& envPath = constants::PCM_ENV_FILE) const;
 
     /**
      * @brief Print this object to the output stream @c os (e.g. std::cout,
@@ -44,7 +53,7 @@ struct Actions_t
      * @code
      *   std::stringstream ss;
      *   obj.print(ss, indent);
-     *   log_dbg("%s", ss.str().c_str());
+     *   log_dbg_dump("%s", ss.str().c_str());
      * @endcode
      */
     template <class CharT>
@@ -17,8 +17,9 @@
 
 #pragma once
 
-#include "dbus_accessor.hpp"
+#include "dbus_backend.hpp"
 
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <string>
@@ -27,6 +28,25 @@
 namespace platform_checks
 {
 
+/** @brief Outcome of the evaluation of one check */
+struct CheckResult
+{
+    /** @brief Objects the property was read from */
+    std::vector<std::string> objects;
+
+    /** @brief Property values read from D-Bus, in the order of objects */
+    std::vector<dbus::DBusValue> values;
+
+    /** @brief Whether the check passed */
+    bool passed = false;
+
+    /** @brief Why the check did not pass, empty when it passed */
+    std::string reason;
+
+    /** @brief Time spent evaluating the check, in us */
+    uint64_t duration = 0;
+};
+
 struct Checks_t
 {
     /** @brief Rule to be followed for the checks ran on each object
@@ -50,23 +70,38 @@ struct Checks_t
      */
     std::vector<std::string> objects;
 
-    /** @brief Variables to store the property values read from D-Bus */
-    std::vector<dbus::DBusValue> dbusPropertyValues;
-
   public:
-    /** @brief Perform the checks present in the struct */
-    bool performChecks();
+    /** @brief Perform the checks present in the struct
+     *
+     * Does not modify the check, so a check can be evaluated concurrently
+     * against different backends.
+     *
+     * @param[in]  backend - Source of the property values
+     * @param[out] result - Filled in with the objects, values and outcome
+     *
+     * @return true if the check passed
+     */
+    bool performChecks(dbus::Backend& backend, CheckResult& result) const;
 
     /** @brief Perform the check to Match All of the property values under the
      * interface*/
-    bool performCheckMatchAll();
+    bool performCheckMatchAll(CheckResult& result) const;
 
     /** @brief Perform the check to Match Any of the property values under the
      * interface*/
-    bool performCheckMatchAny();
+    bool performCheckMatchAny(CheckResult& result) const;
 
     /** @brief Reads all the property values for the interface*/
-    bool readAllPropertiesForInterface();
+    bool readAllPropertiesForInterface(dbus::Backend& backend,
+                                       CheckResult& result) const;
+
+    /** @brief Short one line description of the check,
+     *  e.g. "xyz.openbmc_project.Inventory.Decorator.Asset.Model==H100"
+     */
+    std::string describe() const
+    {
+        return interface + "." + property + "==" + value;
+    }
 
     /**
      * @brief Print this object to the output stream @c os (e.g. std::cout,
@@ -77,7 +112,7 @@ struct Checks_t
      * @code
      *   std::stringstream ss;
      *   obj.print(ss, indent);
-     *   log_dbg("%s", ss.str().c_str());
+     *   log_dbg_dump("%s", ss.str().c_str());
      * @endcode
      */
     template <class CharT>
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "constants.hpp"
 #include "platform_actions.hpp"
 #include "platform_checks.hpp"
 
@@ -24,6 +25,7 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -32,12 +34,50 @@ using json = nlohmann::json;
 namespace platform_config
 {
 
+class Config;
+
+/** @brief Outcome of the evaluation of one platform config */
+struct ConfigResult
+{
+    /** @brief The platform config, for the checks it defines */
+    std::shared_ptr<const Config> config;
+
+    /** @brief Name of the evaluated platform config */
+    std::string name;
+
+    /** @brief File the evaluated platform config was loaded from */
+    std::string file;
+
+    /** @brief Whether the checks of the config were evaluated at all */
+    bool evaluated = false;
+
+    /** @brief Whether the config matched the platform */
+    bool matched = false;
+
+    /** @brief Outcome of the evaluated checks, in the order of the config.
+     *  Checks after the one that decided the rule are not evaluated.
+     */
+    std::vector<platform_checks::CheckResult> checks;
+
+    /** @brief Descriptions of the checks that decided the match */
+    std::vector<std::string> decisiveChecks;
+
+    /** @brief Why the evaluation stopped */
+    std::string reason;
+
+    /** @brief Time spent evaluating the config, in us */
+    uint64_t duration = 0;
+};
+
 class Config
 {
   public:
     /** @brief Name of the Platform **/
     std::string name;
 
+    /** @brief Path of the file the config was loaded from **/
+    std::string file;
+
     /** @brief Rule to be followed for the checks
      *  MatchAll: All of the checks need to be true.
      *  MatchAny: Any of the checks need to be true.
@@ -50,6 +90,7 @@ class Config
     /** @brief Actions to perform once the checks have passed **/
     std::vector<platform_actions::Actions_t> actions;
 
+
   public:
     /** @brief Load class contents from JSON profile
      *
@@ -68,6 +109,14 @@ class Config
      */
     void loadFrom(const json& j);
 
+    /** @brief Load class contents from a JSON profile no longer needed
+     *
+     *  The strings are moved out of the document instead of copied.
+     *
+     *  @param[in]  j - json object, left with empty strings
+     */
+    void loadFrom(json&& j);
+
     /** @brief Dumps current object class content to stdout
      */
     std::string print(void) const;
@@ -76,25 +125,58 @@ class Config
      *
      * Wrapper method for platform_checks::Checks_t.performChecks()
      *
+     * @param[in]  backend - Source of the property values
+     * @param[out] result - Filled in with the outcome of every check
+     *
+     * @return true if the config matches the platform
      */
-    bool performChecks();
+    bool performChecks(dbus::Backend& backend, ConfigResult& result) const;
 
     /** @brief Perform the check to Match All of the checks in Checks vector*/
-    bool performCheckMatchAll();
+    bool performCheckMatchAll(dbus::Backend& backend,
+                              ConfigResult& result) const;
 
     /** @brief Perform the check to Match Any of the checks in Checks vector*/
-    bool performCheckMatchAny();
+    bool performCheckMatchAny(dbus::Backend& backend,
+                              ConfigResult& result) const;
+
+    /** @brief Apply the Rule of this config to the outcome of its checks
+     *
+     * Used to decide a config again from cached check outcomes, without
+     * evaluating the checks that did not change.
+     *
+     * @param[in]  results - Outcome of every check, in the order of checks
+     *
+     * @return true if the config matches the platform
+     */
+    bool matchRule(
+        const std::vector<platform_checks::CheckResult>& results) const;
 
     /** @brief Perform actions in actions_t struct
      *
      * Wrapper method for platform_actions::actions_t.performActions()
      *
+     * @param[in]  envFile - Environment file to write
+     */
+    int performActions(
+        const std::string& envFile = constants::PCM_ENV_FILE) const;
+
+    /** @brief Push the environment of this config into the systemd manager
+     *
+     * All the variables of the actions are sent in a single D-Bus call,
+     * with the name of the config as PCM_NAME rather than NAME. Variables
+     * listed in @c previousNames that are no longer set by this config are
+     * unset in the same call.
+     *
+     * @param[in]  previousNames - Variable names exported by a previous run
+     *
+     * @return 0 on success, non-zero otherwise
      */
-    int performActions();
+    int exportEnvironment(const std::vector<std::string>& previousNames) const;
 
     /** @brief Match Name from Platform Config to the argument name
      */
-    bool matchName(const std::string& name);
+    bool matchName(const std::string& name) const;
 };
 
 } // namespace platform_config
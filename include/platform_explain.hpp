@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "platform_matcher.hpp"
+
+#include <string>
+
+namespace platform_explain
+{
+
+enum class Format
+{
+    json,
+    table
+};
+
+/** @brief Parse "json" or "table"
+ *
+ * @throw std::invalid_argument for any other name
+ */
+Format formatFromName(const std::string& name);
+
+/** @brief Explain an evaluation, from the results the engine collected
+ *
+ * Lists every config with its rule, outcome, time and the reason its
+ * evaluation stopped, and for each check the expected value, the objects
+ * resolved, the values read, the outcome and the time. Checks which were
+ * not evaluated because the rule was already decided are listed too.
+ *
+ * @param[in]  match - Result of PlatformMatcher::evaluate()
+ * @param[in]  format - JSON document or human readable table
+ *
+ * @return the report, ending with a new line
+ */
+std::string explain(const platform_matcher::MatchResult& match,
+                    Format format);
+
+} // namespace platform_explain
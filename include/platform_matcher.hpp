@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "dbus_backend.hpp"
+#include "platform_config.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace platform_matcher
+{
+
+/** @brief Outcome of one evaluation of the platform configurations */
+struct MatchResult
+{
+    /** @brief Matched config, or the default one when none matched. May be
+     *  null if nothing matched and there is no default config.
+     */
+    std::shared_ptr<const platform_config::Config> winner;
+
+    /** @brief true when winner is the default platform configuration */
+    bool isDefault = false;
+
+    /** @brief Outcome of every config, in evaluation order */
+    std::vector<platform_config::ConfigResult> configs;
+
+    /** @brief Time spent evaluating, in us */
+    uint64_t duration = 0;
+
+    /** @brief Requests forwarded to the backend by this evaluation */
+    uint64_t dbusCallCount = 0;
+
+    /** @brief Requests answered by the evaluation cache */
+    uint64_t cacheHits = 0;
+
+    /** @brief Names of all the configs that matched */
+    std::vector<std::string> matches() const;
+};
+
+/** @brief Immutable set of loaded platform configurations */
+struct ConfigSet
+{
+    /** @brief Platform configurations, in evaluation order */
+    std::vector<std::shared_ptr<const platform_config::Config>> configs;
+
+    /** @brief The default platform configuration, may be null */
+    std::shared_ptr<const platform_config::Config> defaultConfig;
+};
+
+/**
+ * @brief Matches the platform against a directory of platform configurations
+ *
+ * The configurations are loaded once, at construction, into an immutable
+ * ConfigSet. evaluate() is const and may be called repeatedly and
+ * concurrently, as long as the backends it is given are thread-safe. reload()
+ * swaps in a new ConfigSet atomically: evaluations in progress keep the set
+ * they started with and are never blocked.
+ *
+ * @code
+ *   platform_matcher::PlatformMatcher matcher("/usr/share/nvidia-pcm/");
+ *   dbus::SystemBackend backend;
+ *   auto result = matcher.evaluate(backend);
+ *   if (result.winner)
+ *   {
+ *       // result.winner->name
+ *   }
+ * @endcode
+ */
+class PlatformMatcher
+{
+  public:
+    /** @brief Load all the platform configurations of a data directory
+     *
+     * Files are evaluated in the order of their path, so the outcome does not
+     * depend on the directory listing order. Files that fail to load are
+     * logged and skipped.
+     *
+     * @param[in]  dataDir - Data directory, e.g. /usr/share/nvidia-pcm/
+     */
+    explicit PlatformMatcher(const std::string& dataDir);
+
+    /** @brief Evaluate the platform configurations
+     *
+     * @param[in]  backend - Source of the property values
+     * @param[in]  stopAtFirstMatch - Stop at the first matching config. When
+     *             false every config is evaluated, which reports ambiguous
+     *             matches; the winner is still the first one.
+     *
+     * @return the winner, the per-config and per-check outcomes and timings
+     */
+    MatchResult evaluate(dbus::Backend& backend,
+                         bool stopAtFirstMatch = true) const;
+
+    /** @brief Find a platform configuration by its Name
+     *
+     * @return the config, or null if there is none with that name
+     */
+    std::shared_ptr<const platform_config::Config>
+        findByName(const std::string& name) const;
+
+    /** @brief The default platform configuration, may be null */
+    std::shared_ptr<const platform_config::Config> getDefaultConfig() const;
+
+    /** @brief Snapshot of the loaded platform configurations */
+    std::shared_ptr<const ConfigSet> getConfigSet() const;
+
+    /** @brief Parse the given files again and swap in the new ConfigSet
+     *
+     * Configs of other files are shared with the previous set. A file that
+     * no longer exists is removed, a file that fails to load keeps its
+     * previous version.
+     *
+     * @param[in]  files - Paths of the changed files
+     *
+     * @return true if the ConfigSet changed
+     */
+    bool reload(const std::vector<std::string>& files);
+
+    /** @brief Directory of the platform configuration files */
+    const std::string& getConfPath() const
+    {
+        return confPath;
+    }
+
+    /** @brief Path of the default platform configuration file */
+    const std::string& getDefaultFile() const
+    {
+        return defaultFile;
+    }
+
+  private:
+    const std::string confPath;
+    const std::string defaultFile;
+
+    std::atomic<std::shared_ptr<const ConfigSet>> configSet;
+    /** @brief Serializes reload(), readers never take it */
+    std::mutex reloadMutex;
+};
+
+} // namespace platform_matcher
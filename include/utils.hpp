@@ -17,15 +17,22 @@
 
 #pragma once
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace utils
 {
 
-const std::string readFileAndFindVariable(const std::string file,
+inline const std::string readFileAndFindVariable(const std::string file,
                                           const std::string variable)
 {
     std::ifstream f(file);
@@ -46,4 +53,60 @@ const std::string readFileAndFindVariable(const std::string file,
     return "";
 }
 
+inline std::vector<std::string> readFileVariableNames(const std::string& file)
+{
+    std::vector<std::string> names;
+    std::ifstream f(file);
+    std::string line;
+    while (std::getline(f, line))
+    {
+        // Collect the name of every variable= line
+        //  e.g. NAME=H100 -> NAME
+        auto pos = line.find("=");
+        if (pos != std::string::npos && pos > 0)
+        {
+            names.push_back(line.substr(0, pos));
+        }
+    }
+    return names;
+}
+
+/**
+ * Write data to file.tmp, then rename it over file, so that readers see
+ * either the previous content or the new one, never a partial file.
+ * Returns false if the file could not be written.
+ */
+inline bool writeFileAtomically(const std::string& file, std::string_view data)
+{
+    auto tmpFile = file + ".tmp";
+    int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    size_t written = 0;
+    while (written < data.size())
+    {
+        auto rc = write(fd, data.data() + written, data.size() - written);
+        if (rc < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (rc <= 0)
+        {
+            close(fd);
+            unlink(tmpFile.c_str());
+            return false;
+        }
+        written += rc;
+    }
+    if (close(fd) < 0 || rename(tmpFile.c_str(), file.c_str()) < 0)
+    {
+        unlink(tmpFile.c_str());
+        return false;
+    }
+    return true;
+}
+
 } // namespace utils
@@ -15,18 +15,27 @@
  * limitations under the License.
  */
 
+#define LOG_CATEGORY dbus
+
 #include "dbus_accessor.hpp"
 
 #include "log.hpp"
+#include "log_trace.hpp"
+#include "pcm_metrics.hpp"
+#include "pcm_report.hpp"
 
 #include <fmt/format.h>
 
 #include <phosphor-logging/log.hpp>
 #include <xyz/openbmc_project/State/Boot/Progress/server.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <sstream>
 log_init;
 
 using namespace sdbusplus::xyz::openbmc_project::State::Boot::server;
@@ -35,20 +44,130 @@ using namespace phosphor::logging;
 namespace dbus
 {
 
+namespace
+{
+std::atomic<uint64_t> callCount{0};
+
+/**
+ * bus.call() accounted in the call count and the metrics. calls is the
+ * counter of the service, looked up once by the call sites with a fixed
+ * service.
+ */
+sdbusplus::message::message call(sdbusplus::bus::bus& bus,
+                                 sdbusplus::message::message& method,
+                                 const char* service,
+                                 pcm_metrics::LabeledCounter::Handle calls)
+{
+    callCount.fetch_add(1, std::memory_order_relaxed);
+    calls.inc();
+    auto begin = std::chrono::steady_clock::now();
+    auto observe = [&begin]() {
+        pcm_metrics::dbusLatency.observe(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - begin)
+                .count());
+    };
+    try
+    {
+        auto reply = bus.call(method);
+        observe();
+        return reply;
+    }
+    catch (...)
+    {
+        observe();
+        pcm_metrics::dbusFailures.inc(service);
+        throw;
+    }
+}
+} // namespace
+
+std::string toString(const DBusValue& value)
+{
+    std::stringstream ss;
+    auto bytes = [&ss](const std::vector<uint8_t>& array) {
+        ss << "[";
+        for (size_t i = 0; i < array.size(); i++)
+        {
+            ss << (i ? " " : "") << std::setfill('0') << std::setw(2)
+               << std::hex << int(array[i]) << std::dec;
+        }
+        ss << "]";
+    };
+
+    std::visit(
+        [&ss, &bytes](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            ss << v;
+        }
+        else if constexpr (std::is_same_v<T, bool>)
+        {
+            ss << (v ? "true" : "false");
+        }
+        else if constexpr (std::is_same_v<T, std::vector<uint8_t>>)
+        {
+            bytes(v);
+        }
+        else if constexpr (std::is_same_v<T, std::vector<std::string>>)
+        {
+            ss << "[";
+            for (size_t i = 0; i < v.size(); i++)
+            {
+                ss << (i ? ", " : "") << v[i];
+            }
+            ss << "]";
+        }
+        else if constexpr (std::is_same_v<T, std::tuple<uint64_t,
+                                                        std::vector<uint8_t>>>)
+        {
+            ss << "(" << std::get<0>(v) << ", ";
+            bytes(std::get<1>(v));
+            ss << ")";
+        }
+        else
+        {
+            ss << "[";
+            for (size_t i = 0; i < v.size(); i++)
+            {
+                ss << (i ? ", " : "") << "(" << std::get<0>(v[i]) << ", "
+                   << std::get<1>(v[i]) << ", " << std::get<2>(v[i]) << ")";
+            }
+            ss << "]";
+        }
+    },
+        value);
+
+    return ss.str();
+}
+
+uint64_t getCallCount()
+{
+    return callCount.load(std::memory_order_relaxed);
+}
+
 void getProperty(const std::string& service, const std::string& objectPath,
                  const std::string& interface, const std::string& property,
                  DBusValue& value)
 {
+    trace_span("dbus", "Get", objectPath, interface, property);
+    pcm_report::Scope phase(pcm_report::Phase::properties);
     auto bus = sdbusplus::bus::new_default();
     auto method = bus.new_method_call(service.c_str(), objectPath.c_str(),
                                       "org.freedesktop.DBus.Properties", "Get");
     method.append(interface, property);
-    auto reply = bus.call(method);
+    logs_dbg("Get %s %s %s.%s\n", service.c_str(), objectPath.c_str(),
+             interface.c_str(), property.c_str());
+    auto reply = call(bus, method, service.c_str(),
+                      pcm_metrics::dbusCalls.handle(service));
     reply.read(value);
 }
 
 DBusSubTree getSubTree(const std::string& intf)
 {
+    trace_span("dbus", "GetSubTree", intf);
+    pcm_report::Scope phase(pcm_report::Phase::mapper);
     DBusSubTree result;
     auto bus = sdbusplus::bus::new_default();
     auto method = bus.new_method_call(service_name::objectMapper,
@@ -57,13 +176,19 @@ DBusSubTree getSubTree(const std::string& intf)
     method.append(std::string{"/"});
     method.append(0);
     method.append(std::vector<std::string>{intf});
-    auto reply = bus.call(method);
+    logs_dbg("GetSubTree %s\n", intf.c_str());
+    static auto calls =
+        pcm_metrics::dbusCalls.handle(service_name::objectMapper);
+    auto reply = call(bus, method, service_name::objectMapper, calls);
     reply.read(result);
+    logs_dbg("GetSubTree %s: %zu objects\n", intf.c_str(), result.size());
     return result;
 }
 
 DBusPathList getPaths(const DBusInterfaceList& interfaces)
 {
+    trace_span("dbus", "GetSubTreePaths");
+    pcm_report::Scope phase(pcm_report::Phase::mapper);
     auto bus = sdbusplus::bus::new_default();
     auto method = bus.new_method_call(
         service_name::objectMapper, object_path::objectMapper,
@@ -71,7 +196,9 @@ DBusPathList getPaths(const DBusInterfaceList& interfaces)
 
     method.append(std::string{"/"}, 0, interfaces);
 
-    auto reply = bus.call(method);
+    static auto calls =
+        pcm_metrics::dbusCalls.handle(service_name::objectMapper);
+    auto reply = call(bus, method, service_name::objectMapper, calls);
 
     DBusPathList paths;
     reply.read(paths);
@@ -82,6 +209,8 @@ DBusPathList getPaths(const DBusInterfaceList& interfaces)
 DBusService getService(const std::string& objectPath,
                        const std::string& interface)
 {
+    trace_span("dbus", "GetObject", objectPath);
+    pcm_report::Scope phase(pcm_report::Phase::mapper);
     auto bus = sdbusplus::bus::new_default();
     auto method = bus.new_method_call(service_name::objectMapper,
                                       object_path::objectMapper,
@@ -89,7 +218,9 @@ DBusService getService(const std::string& objectPath,
 
     method.append(objectPath, std::vector<std::string>({interface}));
 
-    auto reply = bus.call(method);
+    static auto calls =
+        pcm_metrics::dbusCalls.handle(service_name::objectMapper);
+    auto reply = call(bus, method, service_name::objectMapper, calls);
 
     std::map<DBusService, DBusInterfaceList> response;
     reply.read(response);
@@ -102,4 +233,22 @@ DBusService getService(const std::string& objectPath,
     return std::string{};
 }
 
+void setManagerEnvironment(const std::vector<std::string>& unset,
+                           const std::vector<std::string>& assignments)
+{
+    auto bus = sdbusplus::bus::new_default();
+    auto method = bus.new_method_call(
+        service_name::systemd, object_path::systemd, interface::systemdManager,
+        unset.empty() ? "SetEnvironment" : "UnsetAndSetEnvironment");
+
+    if (!unset.empty())
+    {
+        method.append(unset);
+    }
+    method.append(assignments);
+
+    static auto calls = pcm_metrics::dbusCalls.handle(service_name::systemd);
+    call(bus, method, service_name::systemd, calls);
+}
+
 } // namespace dbus
@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dbus_backend.hpp"
+
+#include "dbus_accessor.hpp"
+
+#include <algorithm>
+
+namespace dbus
+{
+
+DBusSubTreePtr SystemBackend::getSubTree(const std::string& interface)
+{
+    return std::make_shared<const DBusSubTree>(dbus::getSubTree(interface));
+}
+
+void SystemBackend::getProperty(const std::string& service,
+                                const std::string& objectPath,
+                                const std::string& interface,
+                                const std::string& property, DBusValue& value)
+{
+    dbus::getProperty(service, objectPath, interface, property, value);
+}
+
+std::string_view CachedBackend::keep(std::string_view key)
+{
+    auto* copy = static_cast<char*>(arena.allocate(key.size(), 1));
+    std::copy(key.begin(), key.end(), copy);
+    return {copy, key.size()};
+}
+
+DBusSubTreePtr CachedBackend::getSubTree(const std::string& interface)
+{
+    auto it = subTrees.find(interface);
+    if (it == subTrees.end())
+    {
+        misses++;
+        Entry<DBusSubTreePtr> entry;
+        try
+        {
+            entry.value = backend.getSubTree(interface);
+        }
+        catch (...)
+        {
+            entry.error = std::current_exception();
+        }
+        it = subTrees.emplace(keep(interface), std::move(entry)).first;
+    }
+    else
+    {
+        hits++;
+    }
+
+    if (it->second.error)
+    {
+        std::rethrow_exception(it->second.error);
+    }
+    return it->second.value;
+}
+
+void CachedBackend::getProperty(const std::string& service,
+                                const std::string& objectPath,
+                                const std::string& interface,
+                                const std::string& property, DBusValue& value)
+{
+    PropertyKey key{service, objectPath, interface, property};
+    auto it = properties.find(key);
+    if (it == properties.end())
+    {
+        misses++;
+        Entry<DBusValue> entry;
+        try
+        {
+            backend.getProperty(service, objectPath, interface, property,
+                                entry.value);
+        }
+        catch (...)
+        {
+            entry.error = std::current_exception();
+        }
+        key = {keep(service), keep(objectPath), keep(interface),
+               keep(property)};
+        it = properties.emplace(key, std::move(entry)).first;
+    }
+    else
+    {
+        hits++;
+    }
+
+    if (it->second.error)
+    {
+        std::rethrow_exception(it->second.error);
+    }
+    value = it->second.value;
+}
+
+} // namespace dbus
@@ -0,0 +1,257 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dbus_capture.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+namespace dbus
+{
+
+namespace
+{
+
+using json = nlohmann::json;
+
+std::string subTreeKey(const std::string& interface)
+{
+    return "T\n" + interface;
+}
+
+std::string propertyKey(const std::string& service,
+                        const std::string& objectPath,
+                        const std::string& interface,
+                        const std::string& property)
+{
+    return "P\n" + service + "\n" + objectPath + "\n" + interface + "\n" +
+           property;
+}
+
+/** Run a request, record its latency and its reply or error in entry */
+template <typename Request>
+void timed(json& entry, Request&& request)
+{
+    auto begin = std::chrono::steady_clock::now();
+    try
+    {
+        request();
+    }
+    catch (const std::exception& e)
+    {
+        entry["e"] = e.what();
+    }
+    entry["us"] = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+}
+
+void valueToJson(const DBusValue& value, json& entry)
+{
+    entry["t"] = value.index();
+    std::visit([&entry](const auto& v) { entry["v"] = v; }, value);
+}
+
+template <size_t I = 0>
+DBusValue valueFromJson(size_t index, const json& j)
+{
+    if constexpr (I < std::variant_size_v<DBusValue>)
+    {
+        if (index == I)
+        {
+            return DBusValue{
+                std::in_place_index<I>,
+                j.get<std::variant_alternative_t<I, DBusValue>>()};
+        }
+        return valueFromJson<I + 1>(index, j);
+    }
+    else
+    {
+        throw std::runtime_error("Unknown D-Bus value type " +
+                                 std::to_string(index));
+    }
+}
+
+} // namespace
+
+DBusSubTreePtr RecordingBackend::getSubTree(const std::string& interface)
+{
+    json entry{{"i", interface}};
+    DBusSubTreePtr tree;
+    timed(entry, [&]() {
+        tree = backend.getSubTree(interface);
+        entry["v"] = *tree;
+    });
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        subTrees.push_back(entry);
+    }
+    if (entry.contains("e"))
+    {
+        throw std::runtime_error(entry["e"].get<std::string>());
+    }
+    return tree;
+}
+
+void RecordingBackend::getProperty(const std::string& service,
+                                   const std::string& objectPath,
+                                   const std::string& interface,
+                                   const std::string& property,
+                                   DBusValue& value)
+{
+    json entry{
+        {"s", service}, {"o", objectPath}, {"i", interface}, {"p", property}};
+    timed(entry, [&]() {
+        backend.getProperty(service, objectPath, interface, property, value);
+        valueToJson(value, entry);
+    });
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        properties.push_back(entry);
+    }
+    if (entry.contains("e"))
+    {
+        throw std::runtime_error(entry["e"].get<std::string>());
+    }
+}
+
+void RecordingBackend::save(const std::string& file) const
+{
+    std::vector<uint8_t> data;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        json capture{{"version", CAPTURE_VERSION},
+                     {"subtrees", subTrees},
+                     {"properties", properties}};
+        data = json::to_cbor(capture);
+    }
+
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    out.close();
+    if (!out.good())
+    {
+        throw std::runtime_error("Capture file (" + file +
+                                 ") cannot be written!");
+    }
+}
+
+ReplayTiming replayTimingFromName(const std::string& name)
+{
+    if (name == "real")
+    {
+        return ReplayTiming::real;
+    }
+    if (name == "fast")
+    {
+        return ReplayTiming::fast;
+    }
+    throw std::invalid_argument("Unknown replay timing " + name +
+                                ", expected real or fast");
+}
+
+ReplayBackend::ReplayBackend(const std::string& file, ReplayTiming timing) :
+    timing(timing)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in.good())
+    {
+        throw std::runtime_error("Capture file (" + file + ") not found!");
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+
+    json capture;
+    try
+    {
+        capture = json::from_cbor(data);
+    }
+    catch (const std::exception& e)
+    {
+        throw std::runtime_error("Capture file (" + file +
+                                 ") is not valid: " + e.what());
+    }
+    if (capture.value("version", 0) != CAPTURE_VERSION)
+    {
+        throw std::runtime_error("Capture file (" + file +
+                                 ") has an unsupported version!");
+    }
+
+    for (auto& entry : capture.at("subtrees"))
+    {
+        auto key = subTreeKey(entry.at("i"));
+        requests[key].replies.push_back(std::move(entry));
+    }
+    for (auto& entry : capture.at("properties"))
+    {
+        auto key = propertyKey(entry.at("s"), entry.at("o"), entry.at("i"),
+                               entry.at("p"));
+        requests[key].replies.push_back(std::move(entry));
+    }
+}
+
+const json& ReplayBackend::reply(const std::string& key)
+{
+    const json* entry = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = requests.find(key);
+        if (it == requests.end())
+        {
+            throw std::runtime_error("Not in the capture");
+        }
+        auto& replies = it->second;
+        entry = &replies.replies[replies.next];
+        if (replies.next + 1 < replies.replies.size())
+        {
+            replies.next++;
+        }
+    }
+
+    if (timing == ReplayTiming::real)
+    {
+        std::this_thread::sleep_for(
+            std::chrono::microseconds(entry->value("us", 0)));
+    }
+    if (entry->contains("e"))
+    {
+        throw std::runtime_error(entry->at("e").get<std::string>());
+    }
+    return *entry;
+}
+
+DBusSubTreePtr ReplayBackend::getSubTree(const std::string& interface)
+{
+    return std::make_shared<const DBusSubTree>(
+        reply(subTreeKey(interface)).at("v").get<DBusSubTree>());
+}
+
+void ReplayBackend::getProperty(const std::string& service,
+                                const std::string& objectPath,
+                                const std::string& interface,
+                                const std::string& property, DBusValue& value)
+{
+    const auto& entry = reply(propertyKey(service, objectPath, interface,
+                                          property));
+    value = valueFromJson(entry.at("t").get<size_t>(), entry.at("v"));
+}
+
+} // namespace dbus
@@ -17,25 +17,394 @@
 
 #include "log.hpp"
 
+#include "log_trace.hpp"
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <systemd/sd-journal.h>
+
+#include <array>
+
 namespace logging
 {
 
+namespace
+{
+
+/** syslog priority of a log level */
+int journalPriority(int level)
+{
+    switch (getLogLevel(level))
+    {
+        case LogLevel::error:
+            return 3; // LOG_ERR
+        case LogLevel::warning:
+            return 4; // LOG_WARNING
+        case LogLevel::information:
+            return 6; // LOG_INFO
+        default:
+            return 7; // LOG_DEBUG
+    }
+}
+
+} // namespace
+
+void Log::openLogFile()
+{
+    if (logFile.size() == 0)
+    {
+        return;
+    }
+
+    // Append, the log of a previous run may tell why it failed
+    logFd = open(logFile.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                 S_IRUSR | S_IWUSR | S_IRGRP);
+    if (logFd < 0)
+    {
+        throw std::runtime_error("Log file (" + logFile + ") open failed!");
+    }
+
+    struct stat st;
+    logFileSize = (fstat(logFd, &st) == 0) ? st.st_size : 0;
+    lastFileFlush = std::chrono::steady_clock::now();
+    if (binaryRequested)
+    {
+        writeBinaryPreamble();
+        binaryMode.store(true, std::memory_order_relaxed);
+    }
+    startFileFlusher();
+}
+
+void Log::closeLogFile()
+{
+    if (logFd < 0)
+    {
+        return;
+    }
+
+    if (isEnabled(LogLevel::information) && !binaryMode.load())
+    {
+        fmt::memory_buffer buffer;
+        appendHeader(buffer, LogLevel::information);
+        buffer.append(std::string_view("=========== End ===========\n"));
+        outputLog({buffer.data(), buffer.size()});
+    }
+    flushLogFile();
+    close(logFd);
+    logFd = -1;
+    binaryMode.store(false, std::memory_order_relaxed);
+}
+
+void Log::flushLogFile()
+{
+    lastFileFlush = std::chrono::steady_clock::now();
+    if (logFd < 0 || pendingLines.size() == 0)
+    {
+        return;
+    }
+
+    writeLogFile({pendingLines.data(), pendingLines.size()}, {});
+    pendingLines.clear();
+}
+
+void Log::writeLogFile(std::string_view first, std::string_view second)
+{
+    auto size = first.size() + second.size();
+    if (fileOptions.rotateBytes != 0 && logFileSize != 0 &&
+        logFileSize + size > fileOptions.rotateBytes)
+    {
+        rotateLogFile();
+        if (logFd < 0)
+        {
+            return;
+        }
+    }
+
+    struct iovec iov[2] = {
+        {const_cast<char*>(first.data()), first.size()},
+        {const_cast<char*>(second.data()), second.size()}};
+    int index = 0;
+    while (index < 2)
+    {
+        auto written = writev(logFd, iov + index, 2 - index);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            fprintf(stderr, "Log file (%s) write failed: %s\n",
+                    logFile.c_str(), strerror(errno));
+            return;
+        }
+
+        logFileSize += written;
+        auto remaining = static_cast<size_t>(written);
+        while (index < 2 && remaining >= iov[index].iov_len)
+        {
+            remaining -= iov[index].iov_len;
+            index++;
+        }
+        if (index < 2)
+        {
+            iov[index].iov_base = static_cast<char*>(iov[index].iov_base) +
+                                  remaining;
+            iov[index].iov_len -= remaining;
+        }
+    }
+}
+
+void Log::rotateLogFile()
+{
+    close(logFd);
+
+    for (auto i = fileOptions.keepFiles; i > 1; i--)
+    {
+        auto from = logFile + "." + std::to_string(i - 1);
+        auto to = logFile + "." + std::to_string(i);
+        rename(from.c_str(), to.c_str());
+    }
+    if (fileOptions.keepFiles > 0)
+    {
+        rename(logFile.c_str(), (logFile + ".1").c_str());
+    }
+    else
+    {
+        unlink(logFile.c_str());
+    }
+
+    logFd = open(logFile.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                 S_IRUSR | S_IWUSR | S_IRGRP);
+    if (logFd < 0)
+    {
+        fprintf(stderr, "Log file (%s) reopen failed: %s\n", logFile.c_str(),
+                strerror(errno));
+        return;
+    }
+    logFileSize = 0;
+    if (binaryMode.load(std::memory_order_relaxed))
+    {
+        writeBinaryPreamble();
+    }
+}
+
+void Log::outputLog(std::string_view msg, bool urgent)
+{
+    if (logFd < 0)
+    {
+        std::cout.write(msg.data(), msg.size());
+        std::cout.flush();
+        return;
+    }
+
+    // Never let pending lines carry the file past the rotation size
+    if (fileOptions.rotateBytes != 0 && pendingLines.size() != 0 &&
+        logFileSize + pendingLines.size() + msg.size() >
+            fileOptions.rotateBytes)
+    {
+        flushLogFile();
+    }
+
+    if (urgent || pendingLines.size() + msg.size() >= fileOptions.flushBytes)
+    {
+        // Pending lines and this message in a single system call
+        writeLogFile({pendingLines.data(), pendingLines.size()}, msg);
+        pendingLines.clear();
+        lastFileFlush = std::chrono::steady_clock::now();
+        return;
+    }
+
+    bool wasEmpty = pendingLines.size() == 0;
+    pendingLines.append(msg);
+    if (std::chrono::steady_clock::now() - lastFileFlush >=
+        fileOptions.flushInterval)
+    {
+        flushLogFile();
+    }
+    else if (wasEmpty)
+    {
+        // The flusher sleeps until there is something to flush
+        fileFlusherCv.notify_one();
+    }
+}
+
+void Log::setBinary(bool enable)
+{
+    // Text lines still in the ring go first
+    flush();
+
+    std::lock_guard<std::mutex> logGuard(lMutex);
+    if (enable == binaryRequested)
+    {
+        return;
+    }
+    binaryRequested = enable;
+    if (logFd < 0)
+    {
+        return;
+    }
+    flushLogFile();
+    if (enable)
+    {
+        writeBinaryPreamble();
+    }
+    binaryMode.store(enable, std::memory_order_relaxed);
+}
+
+void Log::writeBinary(int desiredLevel, uint32_t id, const LogSite& site,
+                      const LogSite& origin, std::string_view record)
+{
+    std::lock_guard<std::mutex> logGuard(lMutex);
+    if (logFd < 0 || !binaryMode.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    if (binarySites
+            .emplace(id, BinarySite{origin.file, origin.line, origin.func,
+                                    site.format})
+            .second)
+    {
+        fmt::memory_buffer siteRecord;
+        binary::putSite(siteRecord, id, origin.file, origin.line, origin.func,
+                        site.format);
+        outputLog({siteRecord.data(), siteRecord.size()});
+    }
+    outputLog(record, getLogLevel(desiredLevel) == LogLevel::error);
+}
+
+void Log::writeBinaryPreamble()
+{
+    fmt::memory_buffer preamble;
+    preamble.append(binary::magic);
+    for (const auto& [id, site] : binarySites)
+    {
+        binary::putSite(preamble, id, site.file, site.line, site.func,
+                        site.format);
+    }
+    writeLogFile({preamble.data(), preamble.size()}, {});
+}
+
+void Log::startFileFlusher()
+{
+    if (fileFlusher.joinable())
+    {
+        return;
+    }
+
+    fileFlusherStop = false;
+    fileFlusher = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(lMutex);
+        while (!fileFlusherStop)
+        {
+            if (pendingLines.size() == 0)
+            {
+                fileFlusherCv.wait(lock);
+                continue;
+            }
+
+            // Let lines batch up for flushInterval after the last flush
+            auto deadline = lastFileFlush +
+                            std::max(fileOptions.flushInterval,
+                                     std::chrono::milliseconds(10));
+            if (fileFlusherCv.wait_until(lock, deadline) ==
+                std::cv_status::timeout)
+            {
+                flushLogFile();
+            }
+        }
+    });
+}
+
+void Log::stopFileFlusher()
+{
+    {
+        std::lock_guard<std::mutex> logGuard(lMutex);
+        if (!fileFlusher.joinable())
+        {
+            return;
+        }
+        fileFlusherStop = true;
+    }
+    fileFlusherCv.notify_all();
+    fileFlusher.join();
+}
+
+void Log::journalSend(int desiredLevel, const LogSite& site,
+                      const char* klass, fmt::memory_buffer& buffer)
+{
+    // Offset and length of every field, pointers are taken once the buffer
+    // stopped growing
+    std::array<std::pair<size_t, size_t>, 32> fields;
+    size_t count = 0;
+
+    size_t size = buffer.size();
+    while (size > 0 && buffer[size - 1] == '\n')
+    {
+        size--;
+    }
+    buffer.resize(size);
+    fields[count++] = {0, size};
+
+    auto addField = [&](std::string_view key, const auto& value) {
+        auto begin = buffer.size();
+        fmt::format_to(fmt::appender(buffer), "{}={}", key, value);
+        fields[count++] = {begin, buffer.size() - begin};
+    };
+    addField("PRIORITY", journalPriority(desiredLevel));
+    addField("CODE_FILE", site.file);
+    addField("CODE_LINE", site.line);
+    addField("CODE_FUNC", site.func);
+    if (klass != nullptr)
+    {
+        addField("PCM_CLASS", klass);
+    }
+    for (const auto& [key, value] : LogField::fields())
+    {
+        if (count == fields.size())
+        {
+            break;
+        }
+        addField(key, value);
+    }
+
+    std::array<struct iovec, fields.size()> iov;
+    for (size_t i = 0; i < count; i++)
+    {
+        iov[i].iov_base = buffer.data() + fields[i].first;
+        iov[i].iov_len = fields[i].second;
+    }
+    if (sd_journal_sendv(iov.data(), static_cast<int>(count)) >= 0)
+    {
+        return;
+    }
+
+    // No journal, keep the message as a text line
+    fmt::memory_buffer line;
+    appendHeader(line, desiredLevel);
+    fmt::format_to(fmt::appender(line), "[{}:{}][{}]: ", site.file, site.line,
+                   site.func);
+    constexpr std::string_view messageKey("MESSAGE=");
+    line.append(buffer.data() + messageKey.size(), buffer.data() + size);
+    line.push_back('\n');
+    flush();
+    std::lock_guard<std::mutex> logGuard(lMutex);
+    outputLog({line.data(), line.size()});
+}
+
 #if defined(LOG_ELAPSED_TIME)
 // initialize static variables
-int LogElapsedTime::_deep = -1;
-std::vector<std::string> LogElapsedTime::_messages;
+thread_local int LogElapsedTime::_deep = -1;
+thread_local std::vector<std::string> LogElapsedTime::_messages;
 
 void LogElapsedTime::calcTimeStamp()
 {
-    struct timespec end;
-    ::clock_gettime(CLOCK_REALTIME, &end);
-    auto seconds = end.tv_sec - _begin.tv_sec;
-    auto nanoseconds = end.tv_nsec - _begin.tv_nsec;
-    float milli = ((float)nanoseconds / 1000000);
-    if (seconds > 0)
+    auto end = trace::now();
+    if (trace::enabled())
     {
-        milli += (seconds * 1000);
+        trace::record("elapsed", _label, _begin, end);
     }
+    double milli = (end - _begin) / 1000000.0;
     char elapsed[128]{0};
     snprintf(elapsed, sizeof(elapsed) - 1, "%9.3f ms %*c %02d ", milli,
              LogElapsedTime::_deep * 2, ' ', LogElapsedTime::_deep);
@@ -45,20 +414,24 @@ void LogElapsedTime::calcTimeStamp()
 
 void LogElapsedTime::printElapsedTree() const
 {
-    std::cout << std::endl;
-    auto size = LogElapsedTime::_messages.size();
-    decltype(size) counter = 0;
-    for (; counter < size; ++counter)
+    // One write, trees of concurrent threads are not interleaved
+    std::string tree{"\n"};
+    for (const auto& message : LogElapsedTime::_messages)
     {
-        std::cout << LogElapsedTime::_messages.at(counter) << std::endl;
+        tree += message;
+        tree += '\n';
     }
     LogElapsedTime::_messages.clear();
-    std::cout << std::endl;
+    tree += '\n';
+
+    static std::mutex printMutex;
+    std::lock_guard<std::mutex> guard(printMutex);
+    std::cout << tree << std::flush;
 }
 
 LogElapsedTime::LogElapsedTime(const char* file, int line, const char* label,
                                const char* fmt, ...) :
-    _msgIndex(LogElapsedTime::_messages.size())
+    _msgIndex(LogElapsedTime::_messages.size()), _label(label)
 {
     std::string msg{"["};
     msg += label;
@@ -88,7 +461,7 @@ LogElapsedTime::LogElapsedTime(const char* file, int line, const char* label,
     msg += ':';
     msg += std::to_string(line);
     LogElapsedTime::_messages.push_back(msg);
-    ::clock_gettime(CLOCK_REALTIME, &_begin);
+    _begin = trace::now();
     LogElapsedTime::_deep++;
 }
 
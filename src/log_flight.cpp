@@ -0,0 +1,372 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "log_flight.hpp"
+
+#include "log.hpp"
+
+#include <fcntl.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace logging
+{
+
+namespace flight
+{
+
+namespace
+{
+
+/** Copy the tail of str, which is the most telling part of a path */
+template <size_t N>
+void copyTail(char (&dest)[N], const char* str)
+{
+    size_t len = strlen(str);
+    const char* begin = (len >= N) ? str + len - (N - 1) : str;
+    strncpy(dest, begin, N - 1);
+    dest[N - 1] = '\0';
+}
+
+template <size_t N>
+void copyHead(char (&dest)[N], const char* str)
+{
+    strncpy(dest, str, N - 1);
+    dest[N - 1] = '\0';
+}
+
+template <size_t N>
+std::string_view view(const char (&str)[N])
+{
+    return {str, strnlen(str, N)};
+}
+
+uint64_t fnv1a(uint64_t hash, const void* data, size_t size)
+{
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/** Object whose GNU build ID note is hashed, by hashBuildId() */
+struct BuildIdSearch
+{
+    /** Address mapped by the object, nullptr for the main executable */
+    const void* address;
+    /** Hash of the build ID, 0 if the object has none */
+    uint64_t hash;
+};
+
+bool mapsAddress(const struct dl_phdr_info* info, const void* address)
+{
+    auto addr = reinterpret_cast<ElfW(Addr)>(address);
+    for (size_t i = 0; i < info->dlpi_phnum; i++)
+    {
+        const auto& phdr = info->dlpi_phdr[i];
+        auto begin = info->dlpi_addr + phdr.p_vaddr;
+        if (phdr.p_type == PT_LOAD && addr >= begin &&
+            addr < begin + phdr.p_memsz)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int hashBuildId(struct dl_phdr_info* info, size_t, void* data)
+{
+    auto search = static_cast<BuildIdSearch*>(data);
+    // The first object is the executable
+    if (search->address != nullptr && !mapsAddress(info, search->address))
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < info->dlpi_phnum; i++)
+    {
+        const auto& phdr = info->dlpi_phdr[i];
+        if (phdr.p_type != PT_NOTE)
+        {
+            continue;
+        }
+        auto note = reinterpret_cast<const char*>(info->dlpi_addr +
+                                                  phdr.p_vaddr);
+        auto end = note + phdr.p_memsz;
+        while (note + sizeof(ElfW(Nhdr)) <= end)
+        {
+            auto header = reinterpret_cast<const ElfW(Nhdr)*>(note);
+            auto name = note + sizeof(ElfW(Nhdr));
+            auto desc = name + ((header->n_namesz + 3) & ~3u);
+            if (header->n_type == NT_GNU_BUILD_ID && header->n_namesz == 4 &&
+                memcmp(name, "GNU", 4) == 0)
+            {
+                search->hash = fnv1a(14695981039346656037ull, desc,
+                                     header->n_descsz);
+                return 1;
+            }
+            note = desc + ((header->n_descsz + 3) & ~3u);
+        }
+    }
+    return 1;
+}
+
+/**
+ * Identity of the running binary: the build ID of the executable, or its
+ * inode, size and modification time when it was linked without one, and
+ * the build ID of the library holding the recorder when it is a shared
+ * one, which logs from its own call sites
+ */
+uint64_t buildIdentity()
+{
+    BuildIdSearch executable{nullptr, 0};
+    dl_iterate_phdr(hashBuildId, &executable);
+    uint64_t hash = executable.hash;
+    struct stat st;
+    if (hash == 0 && stat("/proc/self/exe", &st) == 0)
+    {
+        hash = fnv1a(14695981039346656037ull, &st.st_ino, sizeof(st.st_ino));
+        hash = fnv1a(hash, &st.st_size, sizeof(st.st_size));
+        hash = fnv1a(hash, &st.st_mtim, sizeof(st.st_mtim));
+    }
+
+    BuildIdSearch library{reinterpret_cast<const void*>(&buildIdentity), 0};
+    dl_iterate_phdr(hashBuildId, &library);
+    if (library.hash != 0 && library.hash != executable.hash)
+    {
+        hash = fnv1a(hash, &library.hash, sizeof(library.hash));
+    }
+    return hash;
+}
+
+} // namespace
+
+Recorder::Recorder()
+{
+    int fd = shm_open(SHM_NAME, O_CREAT | O_RDWR | O_CLOEXEC,
+                      S_IRUSR | S_IWUSR | S_IRGRP);
+    if (fd < 0)
+    {
+        throw std::runtime_error(std::string("Flight recorder open failed (") +
+                                 strerror(errno) + ")!");
+    }
+
+    if (ftruncate(fd, sizeof(Block)) < 0)
+    {
+        close(fd);
+        throw std::runtime_error("Flight recorder truncate failed!");
+    }
+
+    void* addr = mmap(nullptr, sizeof(Block), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        throw std::runtime_error("Flight recorder map failed!");
+    }
+    block = static_cast<Block*>(addr);
+
+    auto build = buildIdentity();
+    if (memcmp(block->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        block->version != VERSION || block->slotCount != SLOT_COUNT ||
+        block->siteCount != SITE_COUNT || block->build != build)
+    {
+        // New, from another layout or with the sites of another build,
+        // start over
+        memset(static_cast<void*>(block), 0, sizeof(Block));
+        block->version = VERSION;
+        block->slotCount = SLOT_COUNT;
+        block->siteCount = SITE_COUNT;
+        block->build = build;
+        memcpy(block->magic, MAGIC, sizeof(MAGIC));
+    }
+    block->pid = getpid();
+}
+
+Recorder::~Recorder()
+{
+    // The block is left in place for pcm-dump
+    munmap(block, sizeof(Block));
+}
+
+void Recorder::defineSite(uint32_t id, const char* file, int line,
+                          const char* func, const char* format)
+{
+    for (size_t i = 0; i < SITE_COUNT; i++)
+    {
+        Site& site = block->sites[(id + i) % SITE_COUNT];
+        auto current = site.id.load(std::memory_order_acquire);
+        if (current == id)
+        {
+            return;
+        }
+        if (current == 0 &&
+            site.id.compare_exchange_strong(current, id,
+                                            std::memory_order_acq_rel))
+        {
+            site.line = line;
+            copyTail(site.file, file);
+            copyHead(site.func, func);
+            copyHead(site.format, format);
+            site.ready.store(1, std::memory_order_release);
+            return;
+        }
+        if (current == id)
+        {
+            return;
+        }
+    }
+    // Table full, the records of this site will show as unknown
+}
+
+void Recorder::record(uint32_t id, const char* file, int line,
+                      const char* func, const char* format,
+                      std::string_view record)
+{
+    defineSite(id, file, line, func, format);
+
+    auto size = std::min(record.size(), maxRecord);
+    auto pos = block->head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = block->slots[pos % SLOT_COUNT];
+    slot.seq.store(2 * pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(slot.data, record.data(), size);
+    slot.size = size;
+    slot.seq.store(2 * (pos + 1), std::memory_order_release);
+}
+
+const Block* openBlock()
+{
+    int fd = shm_open(SHM_NAME, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    void* addr = mmap(nullptr, sizeof(Block), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    auto block = static_cast<const Block*>(addr);
+    if (memcmp(block->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        block->version != VERSION)
+    {
+        munmap(addr, sizeof(Block));
+        return nullptr;
+    }
+    return block;
+}
+
+void closeBlock(const Block* block)
+{
+    munmap(const_cast<Block*>(block), sizeof(Block));
+}
+
+size_t dump(const Block& block, fmt::memory_buffer& out, size_t last)
+{
+    auto head = block.head.load(std::memory_order_acquire);
+    auto count = std::min<uint64_t>(head, SLOT_COUNT);
+    if (last != 0)
+    {
+        count = std::min<uint64_t>(count, last);
+    }
+
+    size_t dumped = 0;
+    char data[sizeof(Slot::data)];
+    for (auto pos = head - count; pos < head; pos++)
+    {
+        const Slot& slot = block.slots[pos % SLOT_COUNT];
+        auto seq = slot.seq.load(std::memory_order_acquire);
+        if (seq != 2 * (pos + 1))
+        {
+            // Overwritten or still being written
+            continue;
+        }
+        size_t size = std::min<size_t>(slot.size, sizeof(data));
+        memcpy(data, slot.data, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq)
+        {
+            continue;
+        }
+
+        try
+        {
+            binary::Reader reader({data, size});
+            if (static_cast<binary::Record>(reader.get<uint8_t>()) !=
+                binary::Record::message)
+            {
+                continue;
+            }
+            binary::Message message;
+            binary::readMessage(reader, message);
+
+            const Site* site = nullptr;
+            for (size_t i = 0; i < SITE_COUNT; i++)
+            {
+                const Site& entry = block.sites[(message.id + i) % SITE_COUNT];
+                auto id = entry.id.load(std::memory_order_acquire);
+                if (id == message.id)
+                {
+                    if (entry.ready.load(std::memory_order_acquire))
+                    {
+                        site = &entry;
+                    }
+                    break;
+                }
+                if (id == 0)
+                {
+                    break;
+                }
+            }
+
+            if (site == nullptr)
+            {
+                Log::appendHeader(out, message.flags & binary::levelMask,
+                                  message.ts, message.steady);
+                fmt::format_to(fmt::appender(out), "[unknown site {:08x}]\n",
+                               message.id);
+            }
+            else
+            {
+                Log::appendMessage(out, message, view(site->file), site->line,
+                                   view(site->func), view(site->format));
+            }
+            dumped++;
+        }
+        catch (const std::exception&)
+        {
+            // Torn or truncated record, skip it
+        }
+    }
+    return dumped;
+}
+
+} // namespace flight
+
+} // namespace logging
@@ -0,0 +1,236 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "log_trace.hpp"
+
+#include "utils.hpp"
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace logging
+{
+
+namespace trace
+{
+
+std::atomic<bool> active{false};
+
+namespace
+{
+
+struct Event
+{
+    const char* category;
+    const char* name;
+    int64_t begin;
+    int64_t end;
+    std::string detail;
+};
+
+/**
+ * Spans of one thread. Only the owner thread appends, a chunk is never
+ * moved once allocated, and count publishes the events of a chunk, so the
+ * buffer can be read while the thread is still running.
+ */
+struct Buffer
+{
+    static constexpr size_t chunkSize = 1024;
+
+    struct Chunk
+    {
+        Event events[chunkSize];
+        std::atomic<size_t> count{0};
+        std::atomic<Chunk*> next{nullptr};
+    };
+
+    explicit Buffer(long tid) : tid(tid), head(new Chunk), tail(head)
+    {}
+
+    ~Buffer()
+    {
+        for (auto chunk = head; chunk != nullptr;)
+        {
+            auto next = chunk->next.load(std::memory_order_relaxed);
+            delete chunk;
+            chunk = next;
+        }
+    }
+
+    void append(Event&& event)
+    {
+        auto count = tail->count.load(std::memory_order_relaxed);
+        if (count == chunkSize)
+        {
+            auto chunk = new Chunk;
+            tail->next.store(chunk, std::memory_order_release);
+            tail = chunk;
+            count = 0;
+        }
+        tail->events[count] = std::move(event);
+        tail->count.store(count + 1, std::memory_order_release);
+    }
+
+    long tid;
+    Chunk* head;
+    /** Owner thread only */
+    Chunk* tail;
+};
+
+/** Buffers of all the threads, kept after the threads exit */
+std::mutex buffersMutex;
+std::vector<std::unique_ptr<Buffer>> buffers;
+std::string traceFile;
+int64_t origin = 0;
+
+Buffer& threadBuffer()
+{
+    thread_local Buffer* buffer = nullptr;
+    if (buffer == nullptr)
+    {
+        auto owned = std::make_unique<Buffer>(syscall(SYS_gettid));
+        buffer = owned.get();
+        std::lock_guard<std::mutex> guard(buffersMutex);
+        buffers.push_back(std::move(owned));
+    }
+    return *buffer;
+}
+
+void appendEscaped(fmt::memory_buffer& out, std::string_view str)
+{
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out.push_back('\\');
+            out.push_back(c);
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            fmt::format_to(fmt::appender(out), "\\u{:04x}", c);
+        }
+        else
+        {
+            out.push_back(c);
+        }
+    }
+}
+
+/** Write the whole trace to file */
+bool writeTrace(const std::string& file)
+{
+    fmt::memory_buffer out;
+    auto pid = getpid();
+    fmt::format_to(fmt::appender(out), "{{\"displayTimeUnit\":\"ms\","
+                                       "\"traceEvents\":[\n");
+    fmt::format_to(fmt::appender(out),
+                   "{{\"ph\":\"M\",\"pid\":{},\"name\":\"process_name\","
+                   "\"args\":{{\"name\":\"",
+                   pid);
+    appendEscaped(out, program_invocation_short_name);
+    fmt::format_to(fmt::appender(out), "\"}}}}");
+    {
+        std::lock_guard<std::mutex> guard(buffersMutex);
+        for (const auto& buffer : buffers)
+        {
+            fmt::format_to(fmt::appender(out),
+                           ",\n{{\"ph\":\"M\",\"pid\":{},\"tid\":{},"
+                           "\"name\":\"thread_name\",\"args\":{{\"name\":"
+                           "\"{}\"}}}}",
+                           pid, buffer->tid,
+                           (buffer->tid == pid)
+                               ? std::string("main")
+                               : fmt::format("thread {}", buffer->tid));
+
+            for (auto chunk = buffer->head; chunk != nullptr;
+                 chunk = chunk->next.load(std::memory_order_acquire))
+            {
+                auto count = chunk->count.load(std::memory_order_acquire);
+                for (size_t i = 0; i < count; i++)
+                {
+                    const auto& event = chunk->events[i];
+                    fmt::format_to(
+                        fmt::appender(out),
+                        ",\n{{\"ph\":\"X\",\"pid\":{},\"tid\":{},"
+                        "\"cat\":\"{}\",\"name\":\"{}\",\"ts\":{:.3f},"
+                        "\"dur\":{:.3f}",
+                        pid, buffer->tid, event.category, event.name,
+                        (event.begin - origin) / 1000.0,
+                        (event.end - event.begin) / 1000.0);
+                    if (!event.detail.empty())
+                    {
+                        fmt::format_to(fmt::appender(out),
+                                       ",\"args\":{{\"detail\":\"");
+                        appendEscaped(out, event.detail);
+                        out.push_back('"');
+                        out.push_back('}');
+                    }
+                    out.push_back('}');
+                }
+            }
+        }
+    }
+    fmt::format_to(fmt::appender(out), "\n]}}\n");
+
+    return utils::writeFileAtomically(file, {out.data(), out.size()});
+}
+
+} // namespace
+
+void record(const char* category, const char* name, int64_t begin,
+            int64_t end, std::string_view detail)
+{
+    threadBuffer().append({category, name, begin, end, std::string(detail)});
+}
+
+void start(const std::string& file)
+{
+    int fd = open(file.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Trace file (" + file +
+                                 ") cannot be written: " + strerror(errno));
+    }
+    close(fd);
+
+    traceFile = file;
+    origin = now();
+    active.store(true);
+}
+
+bool stop()
+{
+    if (!active.exchange(false))
+    {
+        return true;
+    }
+    return writeTrace(traceFile);
+}
+
+} // namespace trace
+
+} // namespace logging
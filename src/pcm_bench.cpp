@@ -0,0 +1,193 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pcm_bench.hpp"
+
+#include "log.hpp"
+#include "platform_matcher.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pcm_bench
+{
+
+namespace
+{
+
+constexpr auto phaseCount = static_cast<size_t>(pcm_report::Phase::count);
+
+/** Drop the page cache, the dentries and the inodes, root only */
+void dropCaches()
+{
+    sync();
+    int fd = open("/proc/sys/vm/drop_caches", O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::runtime_error(std::string("Unable to drop the caches: ") +
+                                 strerror(errno));
+    }
+    auto rc = write(fd, "3", 1);
+    auto error = errno;
+    close(fd);
+    if (rc != 1)
+    {
+        // Warm iterations reported as cold ones would be misleading
+        throw std::runtime_error(std::string("Unable to drop the caches: ") +
+                                 strerror(error));
+    }
+}
+
+/** Nearest-rank percentiles of the samples */
+Distribution distribution(std::vector<int64_t> samples)
+{
+    Distribution result;
+    if (samples.empty())
+    {
+        return result;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto rank = [&samples](size_t percent) {
+        return samples[(samples.size() * percent + 99) / 100 - 1];
+    };
+    result.min = samples.front();
+    result.median = rank(50);
+    result.p95 = rank(95);
+    result.max = samples.back();
+    return result;
+}
+
+void appendRow(fmt::memory_buffer& out, const char* name,
+               const Distribution& d, const char* unit)
+{
+    fmt::format_to(fmt::appender(out), "{:<12} {:>10} {:>10} {:>10} {:>10}{}\n",
+                   name, d.min, d.median, d.p95, d.max, unit);
+}
+
+} // namespace
+
+Mode modeFromName(const std::string& name)
+{
+    if (name == "cold")
+    {
+        return Mode::cold;
+    }
+    if (name == "warm")
+    {
+        return Mode::warm;
+    }
+    throw std::invalid_argument("Unknown benchmark mode " + name +
+                                ", expected cold or warm");
+}
+
+Result run(const std::string& dataDir, dbus::Backend& backend,
+           size_t iterations, Mode mode)
+{
+    if (iterations == 0)
+    {
+        throw std::invalid_argument("At least one iteration is needed");
+    }
+    pcm_report::setEnabled(true);
+
+    Result result;
+    result.iterations = iterations;
+    result.mode = mode;
+
+    std::vector<int64_t> total;
+    std::array<std::vector<int64_t>, phaseCount> phases;
+    std::vector<int64_t> dbusCalls;
+    std::vector<int64_t> cacheHits;
+
+    // The untimed iteration of the warm mode is number 0
+    size_t first = (mode == Mode::warm) ? 0 : 1;
+    for (size_t i = first; i <= iterations; i++)
+    {
+        if (mode == Mode::cold)
+        {
+            dropCaches();
+        }
+        auto phasesBefore = pcm_report::wallTimes();
+        auto begin = std::chrono::steady_clock::now();
+
+        platform_matcher::PlatformMatcher matcher(dataDir);
+        auto match = matcher.evaluate(backend);
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - begin)
+                           .count();
+        auto phasesAfter = pcm_report::wallTimes();
+        logs_dbg("Benchmark iteration %zu: %ld us\n", i, elapsed);
+        if (i == 0)
+        {
+            continue;
+        }
+
+        total.push_back(elapsed);
+        for (size_t p = 0; p < phases.size(); p++)
+        {
+            phases[p].push_back(phasesAfter[p] - phasesBefore[p]);
+        }
+        dbusCalls.push_back(match.dbusCallCount);
+        cacheHits.push_back(match.cacheHits);
+        result.winner = match.winner ? match.winner->name : "";
+    }
+
+    result.total = distribution(std::move(total));
+    for (size_t p = 0; p < phases.size(); p++)
+    {
+        result.phases[p] = distribution(std::move(phases[p]));
+    }
+    result.dbusCalls = distribution(std::move(dbusCalls));
+    result.cacheHits = distribution(std::move(cacheHits));
+    return result;
+}
+
+std::string toTable(const Result& result)
+{
+    fmt::memory_buffer out;
+    fmt::format_to(fmt::appender(out),
+                   "{} {} iterations, winner: {}\n"
+                   "{:<12} {:>10} {:>10} {:>10} {:>10}\n",
+                   result.iterations,
+                   result.mode == Mode::cold ? "cold" : "warm",
+                   result.winner.empty() ? "none" : result.winner, "", "min",
+                   "median", "p95", "max");
+    appendRow(out, "total", result.total, " us");
+    for (size_t p = 0; p < result.phases.size(); p++)
+    {
+        // Phases outside of the pipeline, e.g. args and actions, stay at 0
+        if (result.phases[p].max != 0)
+        {
+            appendRow(out, pcm_report::phaseNames[p], result.phases[p], " us");
+        }
+    }
+    appendRow(out, "dbus calls", result.dbusCalls, "");
+    appendRow(out, "cache hits", result.cacheHits, "");
+    return fmt::to_string(out);
+}
+
+} // namespace pcm_bench
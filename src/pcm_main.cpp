@@ -17,12 +17,34 @@
 
 #include "cmd_line.hpp"
 #include "constants.hpp"
+#include "dbus_capture.hpp"
 #include "log.hpp"
-#include "platform_config.hpp"
+#include "log_trace.hpp"
+#include "pcm_bench.hpp"
+#include "pcm_metrics.hpp"
+#include "pcm_object.hpp"
+#include "pcm_reload.hpp"
+#include "pcm_report.hpp"
+#include "pcm_shm.hpp"
+#include "pcm_watch.hpp"
+#include "platform_explain.hpp"
+#include "platform_matcher.hpp"
 #include "utils.hpp"
 
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/signal.hpp>
+#include <sdeventplus/utility/timer.hpp>
+#include <systemd/sd-daemon.h>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <exception>
 #include <filesystem>
 #include <iostream>
+#include <optional>
 #include <string>
 
 namespace fs = std::filesystem;
@@ -35,6 +57,18 @@ struct Configuration
     bool helpOptSet = false;
     std::string data_dir;
     bool skipChecks = false;
+    std::string envFile = constants::PCM_ENV_FILE;
+    bool systemdEnv = false;
+    bool publish = false;
+    bool watch = false;
+    std::string reportFile = constants::PCM_REPORT_FILE;
+    std::string metricsFile;
+    std::optional<platform_explain::Format> explain;
+    std::string captureFile;
+    std::string replayFile;
+    dbus::ReplayTiming replayTiming = dbus::ReplayTiming::fast;
+    size_t benchIterations = 0;
+    pcm_bench::Mode benchMode = pcm_bench::Mode::warm;
 };
 
 Configuration configuration;
@@ -53,6 +87,101 @@ int setLogLevel(cmd_line::ArgFuncParamType params)
     return 0;
 }
 
+int setLogAsync(cmd_line::ArgFuncParamType params)
+{
+    if (params[0] == "drop")
+    {
+        log_set_async(LogOverflow::drop);
+    }
+    else if (params[0] == "block")
+    {
+        log_set_async(LogOverflow::block);
+    }
+    else
+    {
+        throw std::runtime_error("Unknown overflow policy: " + params[0] +
+                                 "!");
+    }
+
+    return 0;
+}
+
+int setCategoryLevel(cmd_line::ArgFuncParamType params)
+{
+    // Pairs of the option given once or more
+    for (size_t i = 0; i + 1 < params.size(); i += 2)
+    {
+        auto category = logging::ctrl::categoryFromName(params[i]);
+        if (!category)
+        {
+            throw std::runtime_error("Unknown log category: " + params[i] +
+                                     "!");
+        }
+
+        int newLvl = std::stoi(params[i + 1]);
+        if (newLvl < 0 || newLvl > 4)
+        {
+            throw std::runtime_error("Level of our range[0-4]!");
+        }
+
+        log_set_category_level(*category, newLvl);
+    }
+
+    return 0;
+}
+
+int setFlightLevel(cmd_line::ArgFuncParamType params)
+{
+    int newLvl = std::stoi(params[0]);
+
+    if (newLvl < 0 || newLvl > 4)
+    {
+        throw std::runtime_error("Level of our range[0-4]!");
+    }
+
+    log_set_flight(newLvl);
+
+    return 0;
+}
+
+int setLogClock(cmd_line::ArgFuncParamType params)
+{
+    if (params[0] == "monotonic")
+    {
+        log_set_clock(LogClock::monotonic);
+    }
+    else if (params[0] == "boottime")
+    {
+        log_set_clock(LogClock::boottime);
+    }
+    else
+    {
+        throw std::runtime_error("Unknown clock: " + params[0] + "!");
+    }
+
+    return 0;
+}
+
+int setLogRotation(cmd_line::ArgFuncParamType params)
+{
+    LogFileOptions options;
+    options.rotateBytes = std::stoul(params[0]);
+    options.keepFiles = std::stoul(params[1]);
+    log_set_file_options(options);
+
+    return 0;
+}
+
+int setLogRate(cmd_line::ArgFuncParamType params)
+{
+    LogRateLimit limit;
+    limit.perSecond = std::stoul(params[0]);
+    limit.burst = std::stoul(params[1]);
+    log_set_rate_limit(limit);
+
+    return 0;
+}
+
 int loadDataDir(cmd_line::ArgFuncParamType params)
 {
     if (params[0].size() == 0)
@@ -84,11 +213,159 @@ static cmd_line::CmdLineArgs cmdLineArgs = {
      "Nvidia-PCM Data Directory. e.g. /usr/share/nvidia-pcm", loadDataDir},
     {"-l", "--log-level", cmd_line::OptFlag::overwrite, "<level>",
      cmd_line::ActFlag::normal, "Debug Log Level [0-4].", setLogLevel},
+    {"-a", "--log-async", cmd_line::OptFlag::overwrite, "<drop|block>",
+     cmd_line::ActFlag::normal,
+     "Log asynchronously from a background thread. When the log ring is "
+     "full, drop messages or block.",
+     setLogAsync},
+    {"-L", "--log-category", cmd_line::OptFlag::append,
+     "<category> <level>", cmd_line::ActFlag::normal,
+     "Debug Log Level [0-4] of one category: main, dbus, config, checks "
+     "or actions. Also changed at runtime with pcm-logctl.",
+     setCategoryLevel},
+    {"-F", "--flight-level", cmd_line::OptFlag::overwrite, "<level>",
+     cmd_line::ActFlag::normal,
+     "Level [0-4] of the messages kept in the shared memory flight "
+     "recorder, read with pcm-dump. Default 3 (debug), costly debug "
+     "dumps such as the loaded configuration are not recorded.",
+     setFlightLevel},
+    {"-c", "--log-clock", cmd_line::OptFlag::overwrite,
+     "<monotonic|boottime>", cmd_line::ActFlag::normal,
+     "Prefix every log line with the given clock in microseconds.",
+     setLogClock},
+    {"-o", "--log-file", cmd_line::OptFlag::overwrite, "<file>",
+     cmd_line::ActFlag::normal,
+     "Append log messages to the given file instead of standard output.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    log_set_file(params[0]);
+    return 0;
+}},
+    {"-t", "--trace", cmd_line::OptFlag::overwrite, "<file>",
+     cmd_line::ActFlag::normal,
+     "Trace config loads, D-Bus calls and actions, and write the trace as "
+     "Chrome trace JSON to the given file at exit.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    logging::trace::start(params[0]);
+    return 0;
+}},
+    {"-r", "--log-rotate", cmd_line::OptFlag::overwrite, "<bytes> <count>",
+     cmd_line::ActFlag::normal,
+     "Rotate the log file before it exceeds the given size, keeping the "
+     "given number of old files.",
+     setLogRotation},
+    {"-R", "--log-rate", cmd_line::OptFlag::overwrite,
+     "<per-second> <burst>", cmd_line::ActFlag::normal,
+     "Limit the errors and warnings of each log call site, 0 turns the "
+     "limit off.",
+     setLogRate},
+    {"-b", "--log-binary", cmd_line::OptFlag::none, "",
+     cmd_line::ActFlag::normal,
+     "Write binary records to the log file, decode them with "
+     "pcm-logdecode.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    log_set_binary(true);
+    return 0;
+}},
+    {"-j", "--log-journal", cmd_line::OptFlag::none, "",
+     cmd_line::ActFlag::normal,
+     "Send log messages to the systemd journal with structured fields.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    log_set_journal(true);
+    return 0;
+}},
+    {"-P", "--report", cmd_line::OptFlag::overwrite, "<file|none>",
+     cmd_line::ActFlag::normal,
+     "Write the run report (time and resources of each phase) to the given "
+     "file at exit, default " +
+         constants::PCM_REPORT_FILE + ".",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    configuration.reportFile = (params[0] == "none") ? "" : params[0];
+    pcm_report::setEnabled(!configuration.reportFile.empty());
+    return 0;
+}},
+    {"-m", "--metrics", cmd_line::OptFlag::overwrite, "<file>",
+     cmd_line::ActFlag::normal,
+     "Write the metrics in the Prometheus text format to the given file at "
+     "exit, and periodically in watch mode.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    configuration.metricsFile = params[0];
+    return 0;
+}},
+    {"-x", "--explain", cmd_line::OptFlag::overwrite, "<json|table>",
+     cmd_line::ActFlag::normal,
+     "Print how every platform configuration and check was evaluated.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    configuration.explain = platform_explain::formatFromName(params[0]);
+    return 0;
+}},
+    {"-C", "--capture", cmd_line::OptFlag::overwrite, "<file>",
+     cmd_line::ActFlag::normal,
+     "Record the inventory replies of the evaluation, with their latency, "
+     "to the given file.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    configuration.captureFile = params[0];
+    return 0;
+}},
+    {"-Y", "--replay", cmd_line::OptFlag::overwrite, "<file> <real|fast>",
+     cmd_line::ActFlag::normal,
+     "Evaluate against a recorded inventory instead of D-Bus, with the "
+     "recorded or no latency. No action is performed.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    configuration.replayFile = params[0];
+    configuration.replayTiming = dbus::replayTimingFromName(params[1]);
+    return 0;
+}},
+    {"-B", "--bench", cmd_line::OptFlag::overwrite, "<iterations> <cold|warm>",
+     cmd_line::ActFlag::normal,
+     "Load and evaluate the platform configurations the given number of "
+     "times, dropping the page cache first or after a warm-up, and print "
+     "the latency distributions. No action is performed.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    configuration.benchIterations = std::stoul(params[0]);
+    configuration.benchMode = pcm_bench::modeFromName(params[1]);
+    if (configuration.benchIterations == 0)
+    {
+        throw std::runtime_error("At least one iteration is needed!");
+    }
+    return 0;
+}},
+    {"-E", "--env-file", cmd_line::OptFlag::overwrite, "<file>",
+     cmd_line::ActFlag::normal,
+     "Write the environment of the actions to the given file, default " +
+         constants::PCM_ENV_FILE + ".",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    configuration.envFile = params[0];
+    return 0;
+}},
     {"-s", "--skip-checks", cmd_line::OptFlag::none, "",
      cmd_line::ActFlag::normal, "Skip platform checks on reboots.",
      []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
     configuration.skipChecks = true;
     return 0;
+}},
+    {"-e", "--systemd-env", cmd_line::OptFlag::none, "",
+     cmd_line::ActFlag::normal,
+     "Also push the environment into the systemd manager, with the "
+     "platform name as PCM_NAME instead of NAME.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    configuration.systemdEnv = true;
+    return 0;
+}},
+    {"-p", "--publish", cmd_line::OptFlag::none, "",
+     cmd_line::ActFlag::normal,
+     "Stay resident and publish the result on D-Bus at "
+     "/xyz/openbmc_project/pcm.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    configuration.publish = true;
+    return 0;
+}},
+    {"-w", "--watch", cmd_line::OptFlag::none, "",
+     cmd_line::ActFlag::normal,
+     "Stay resident and apply the platform configuration again when the "
+     "inventory or the platform configuration files change.",
+     []([[maybe_unused]] cmd_line::ArgFuncParamType params) -> int {
+    configuration.watch = true;
+    return 0;
 }}};
 
 int showHelp()
@@ -104,15 +381,332 @@ int showHelp()
     return 0;
 }
 
+void publishSharedResult(const platform_config::Config& platformConfig,
+                         pcm_shm::Status status)
+{
+    std::vector<std::string> variables{"NAME=" + platformConfig.name};
+    for (const auto& action : platformConfig.actions)
+    {
+        variables.insert(variables.end(), action.variables.begin(),
+                         action.variables.end());
+    }
+
+    try
+    {
+        static pcm_shm::Writer writer;
+        auto generation = writer.publish(platformConfig.name, status,
+                                         variables);
+        logs_dbg("Published result %s to SMEM, generation=%u\n",
+                 platformConfig.name.c_str(), generation);
+    }
+    catch (const std::exception& e)
+    {
+        logs_err("Exception occurred while publishing result to SMEM: %s\n",
+                 e.what());
+    }
+}
+
+int applyPlatformConfig(const platform_config::Config& platformConfig,
+                        pcm_shm::Status status = pcm_shm::Status::matched)
+{
+    pcm_report::Scope phase(pcm_report::Phase::actions);
+    // Names exported by the previous run, to be unset if no longer present
+    std::vector<std::string> previousNames;
+    if (configuration.systemdEnv)
+    {
+        previousNames =
+            utils::readFileVariableNames(configuration.envFile);
+    }
+
+    int rc = platformConfig.performActions(configuration.envFile);
+    if (rc != 0)
+    {
+        publishSharedResult(platformConfig, pcm_shm::Status::failed);
+        return rc;
+    }
+    publishSharedResult(platformConfig, status);
+
+    // The EnvironmentFile stays as the fallback, a failure here is not fatal
+    if (configuration.systemdEnv &&
+        platformConfig.exportEnvironment(previousNames) != 0)
+    {
+        logs_err("Unable to export environment to systemd manager for %s\n",
+                 platformConfig.name.c_str());
+    }
+
+    return 0;
+}
+
+void writeRunReport()
+{
+    if (!configuration.reportFile.empty() &&
+        !pcm_report::write(configuration.reportFile))
+    {
+        logs_err("Unable to write the run report to %s\n",
+                 configuration.reportFile.c_str());
+    }
+}
+
+void writeMetrics()
+{
+    if (!configuration.metricsFile.empty() &&
+        !pcm_metrics::write(configuration.metricsFile))
+    {
+        logs_err("Unable to write the metrics to %s\n",
+                 configuration.metricsFile.c_str());
+    }
+}
+
+void writeTrace()
+{
+    if (!logging::trace::stop())
+    {
+        logs_err("Unable to write the trace\n");
+    }
+}
+
+uint64_t elapsedMicroseconds(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - begin)
+        .count();
+}
+
+pcm_object::Result
+    makeResult(const platform_config::Config& platformConfig,
+               const platform_matcher::MatchResult& match)
+{
+    pcm_object::Result result;
+    result.name = platformConfig.name;
+    result.configFile = platformConfig.file;
+    result.evaluationDuration = match.duration;
+    result.dbusCallCount = match.dbusCallCount;
+    for (const auto& config : match.configs)
+    {
+        if (config.matched && config.name == platformConfig.name)
+        {
+            result.matchedChecks = config.decisiveChecks;
+            break;
+        }
+    }
+    return result;
+}
+
+int runResident(platform_matcher::PlatformMatcher& matcher,
+                const pcm_object::Result& result)
+{
+    if (!configuration.publish && !configuration.watch)
+    {
+        return 0;
+    }
+
+    try
+    {
+        auto bus = sdbusplus::bus::new_default();
+        auto event = sdeventplus::Event::get_default();
+        bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+        // Stopping the unit leaves the loop and returns from main, so the
+        // reports, the trace and the pending log lines are all written
+        sigset_t stopSignals;
+        sigemptyset(&stopSignals);
+        sigaddset(&stopSignals, SIGTERM);
+        sigaddset(&stopSignals, SIGINT);
+        if (sigprocmask(SIG_BLOCK, &stopSignals, nullptr) != 0)
+        {
+            throw std::runtime_error("Unable to block stop signals");
+        }
+        auto onStop = [](sdeventplus::source::Signal& source,
+                         const struct signalfd_siginfo* info) {
+            logs_info("Received signal %u, exiting\n", info->ssi_signo);
+            source.get_event().exit(0);
+        };
+        sdeventplus::source::Signal sigterm(event, SIGTERM, onStop);
+        sdeventplus::source::Signal sigint(event, SIGINT, onStop);
+
+        std::unique_ptr<pcm_object::ResultObject> object;
+        if (configuration.publish)
+        {
+            object = std::make_unique<pcm_object::ResultObject>(
+                bus, dbus::object_path::pcm);
+            object->update(result);
+            bus.request_name(dbus::service_name::pcm);
+            logs_dbg("Publishing result for %s on D-Bus.\n",
+                     result.name.c_str());
+        }
+
+        dbus::SystemBackend backend;
+        std::unique_ptr<pcm_watch::Watcher> watcher;
+        if (configuration.watch)
+        {
+            watcher = std::make_unique<pcm_watch::Watcher>(
+                bus, event, matcher, backend, result.name,
+                [&object](const platform_matcher::MatchResult& match) {
+                if (!match.winner)
+                {
+                    return;
+                }
+                try
+                {
+                    int rc = applyPlatformConfig(
+                        *match.winner, match.isDefault
+                                           ? pcm_shm::Status::defaulted
+                                           : pcm_shm::Status::matched);
+                    if (rc != 0)
+                    {
+                        logs_err("Unable to perform actions, rc=%d\n", rc);
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    logs_err("Exception occurred: %s\n", e.what());
+                }
+                if (object)
+                {
+                    object->update(makeResult(*match.winner, match));
+                }
+            });
+            // Pings the systemd watchdog if WatchdogSec= is set for the unit
+            event.set_watchdog(true);
+        }
+
+        std::unique_ptr<pcm_reload::Reloader> reloader;
+        if (configuration.watch)
+        {
+            reloader = std::make_unique<pcm_reload::Reloader>(
+                event, matcher, constants::RELOAD_DEBOUNCE,
+                [&watcher]() { watcher->reload(); });
+        }
+
+        std::optional<
+            sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>
+            metricsTimer;
+        if (configuration.watch && !configuration.metricsFile.empty())
+        {
+            metricsTimer.emplace(
+                event, [](auto&) { writeMetrics(); },
+                constants::METRICS_INTERVAL);
+        }
+
+        // The boot is over, the reports are written again at exit
+        writeRunReport();
+        writeMetrics();
+        sd_notify(0, "READY=1");
+        int rc = event.loop();
+        // Stopped explicitly, before the sources and the log ring go away
+        writeTrace();
+        return rc;
+    }
+    catch (const std::exception& e)
+    {
+        logs_err("Exception occurred while running resident: %s\n",
+                 e.what());
+    }
+    return 1;
+}
+
+/** Write the flight recorder to stderr, used when pcmd terminates */
+void dumpFlightRecorder()
+{
+    auto recorder = logger.getFlightRecorder();
+    if (recorder == nullptr)
+    {
+        return;
+    }
+
+    fmt::memory_buffer out;
+    logging::flight::dump(recorder->getBlock(), out);
+    std::cerr << "Flight recorder:\n";
+    std::cerr.write(out.data(), out.size());
+    std::cerr.flush();
+}
+
+/**
+ * On an uncaught exception dump the flight recorder before aborting. On a
+ * fatal signal nothing is formatted, the recorder stays in shared memory
+ * for pcm-dump.
+ */
+void installCrashHandlers()
+{
+    std::set_terminate([]() {
+        if (auto e = std::current_exception())
+        {
+            try
+            {
+                std::rethrow_exception(e);
+            }
+            catch (const std::exception& ex)
+            {
+                std::cerr << "Uncaught exception: " << ex.what() << "\n";
+            }
+            catch (...)
+            {
+                std::cerr << "Uncaught exception\n";
+            }
+        }
+        dumpFlightRecorder();
+        std::abort();
+    });
+
+    struct sigaction action = {};
+    action.sa_flags = SA_RESETHAND;
+    action.sa_handler = [](int sig) {
+        constexpr char msg[] = "pcmd crashed, run pcm-dump to read the "
+                               "flight recorder\n";
+        auto rc = write(STDERR_FILENO, msg, sizeof(msg) - 1);
+        (void)rc;
+        raise(sig);
+    };
+    for (int sig : {SIGSEGV, SIGBUS, SIGFPE, SIGILL})
+    {
+        sigaction(sig, &action, nullptr);
+    }
+}
+
+int runBench()
+{
+    try
+    {
+        dbus::SystemBackend system;
+        std::optional<dbus::ReplayBackend> replay;
+        dbus::Backend* backend = &system;
+        if (!configuration.replayFile.empty())
+        {
+            backend = &replay.emplace(configuration.replayFile,
+                                      configuration.replayTiming);
+        }
+        auto result = pcm_bench::run(configuration.data_dir, *backend,
+                                     configuration.benchIterations,
+                                     configuration.benchMode);
+        std::cout << pcm_bench::toTable(result) << std::flush;
+    }
+    catch (const std::exception& e)
+    {
+        logs_err("Exception occurred: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
+
 int main(int argc, char* argv[])
 {
     logger.setLevel(DEF_DBG_LEVEL);
+    try
+    {
+        log_set_flight(LogLevel::debug);
+    }
+    catch (const std::exception& e)
+    {
+        logs_wrn("Flight recorder not available: %s\n", e.what());
+    }
+    installCrashHandlers();
     logs_info("Default log level: %d. Current log level: %d\n", DEF_DBG_LEVEL,
               getLogLevel(logger.getLevel()));
     int rc = 0;
 
     try
     {
+        pcm_report::Scope phase(pcm_report::Phase::args);
         cmd_line::CmdLine cmdLine(argc, argv, cmdLineArgs);
         rc = cmdLine.parse();
         rc = cmdLine.process();
@@ -123,10 +717,27 @@ int main(int argc, char* argv[])
         showHelp();
         return rc ? rc : 1; // ensure exit is always non-zero
     }
-    const std::string PCM_PLATFORM_CONF_PATH = configuration.data_dir +
-                                               "platform-configuration-files/";
     const std::string PCM_DEFAULT_PLATFORM_CONF_FILE =
         configuration.data_dir + constants::DEFAULT_CONF_FILE_NAME;
+    if (configuration.benchIterations)
+    {
+        return runBench();
+    }
+    if (!configuration.reportFile.empty())
+    {
+        std::atexit(writeRunReport);
+    }
+    if (!configuration.metricsFile.empty())
+    {
+        std::atexit(writeMetrics);
+    }
+    if (logging::trace::enabled())
+    {
+        std::atexit(writeTrace);
+    }
+
+    const auto evaluationBegin = std::chrono::steady_clock::now();
+    platform_matcher::PlatformMatcher matcher(configuration.data_dir);
 
     //
     // 1. Check if EnvironmentFile exists:
@@ -146,50 +757,35 @@ int main(int argc, char* argv[])
     try
     {
         if (configuration.skipChecks == true &&
-            fs::exists(constants::PCM_ENV_FILE))
+            configuration.replayFile.empty() &&
+            fs::exists(configuration.envFile))
         {
             logs_dbg("Environment File exists, Reading variable NAME.\n");
-            auto name = utils::readFileAndFindVariable(constants::PCM_ENV_FILE,
+            auto name = utils::readFileAndFindVariable(configuration.envFile,
                                                        "NAME");
             if (!name.empty())
             {
                 logs_dbg("Found Env Variable NAME=%s\n", name.c_str());
-                logs_dbg(
-                    "Iterating over Platform Configuration files in directory: %s\n",
-                    PCM_PLATFORM_CONF_PATH.c_str());
-                // 1. Iterate over all the platform configuration files
-                // 2. Match the key Name in the config file to NAME variable
-                // 3. Perform actions for the matched platform configuration
-                // file
-                for (auto& file :
-                     fs::directory_iterator(PCM_PLATFORM_CONF_PATH))
+                // Match the key Name in the config files to NAME variable
+                // and perform actions for the matched platform configuration
+                if (auto platformConfig = matcher.findByName(name))
                 {
-                    logs_dbg("Iterating Platform Config file: %s\n",
-                             file.path().c_str());
-                    platform_config::Config platformConfig;
-                    if (!platformConfig.loadFromFile(file.path()))
+                    // Perform actions for the matched Platform config file
+                    int rc = applyPlatformConfig(*platformConfig);
+                    if (rc == 0)
                     {
-                        logs_err("Unable to access Platform Config file: %s\n",
-                                 file.path().c_str());
-                        continue;
-                    }
-
-                    // Check if Name key in Platform config file matches
-                    // variable NAME
-                    if (platformConfig.matchName(name))
-                    {
-                        // Perform actions for the matched Platform config file
-                        int rc = platformConfig.performActions();
-                        if (rc != 0)
-                        {
-                            logs_err("Unable to perform actions, rc=%d\n", rc);
-                            break;
-                        }
                         logs_err(
                             "Successfully loaded platform configuration: %s, Exiting.\n",
-                            platformConfig.name.c_str());
-                        return 0;
+                            platformConfig->name.c_str());
+                        pcm_object::Result result;
+                        result.name = platformConfig->name;
+                        result.configFile = platformConfig->file;
+                        result.evaluationDuration =
+                            elapsedMicroseconds(evaluationBegin);
+                        result.matchedChecks = {"NAME==" + name};
+                        return runResident(matcher, result);
                     }
+                    logs_err("Unable to perform actions, rc=%d\n", rc);
                 }
             }
         }
@@ -199,64 +795,97 @@ int main(int argc, char* argv[])
         logs_err("Exception occurred: %s\n", e.what());
     }
 
+    // 1. Perform checks for each platform configuration file
+    // 2. Perform actions for the matched platform configuration file
+    platform_matcher::MatchResult match;
     try
     {
-        logs_dbg(
-            "Iterating over Platform Configuration files in directory: %s\n",
-            PCM_PLATFORM_CONF_PATH.c_str());
-        // 1. Iterate over all the platform configuration files
-        // 2. Perform checks for each file
-        // 3. Perform actions for the matched platform configuration file
-        for (auto& file : fs::directory_iterator(PCM_PLATFORM_CONF_PATH))
+        dbus::SystemBackend system;
+        std::optional<dbus::RecordingBackend> recorder;
+        std::optional<dbus::ReplayBackend> replay;
+        dbus::Backend* backend = &system;
+        if (!configuration.replayFile.empty())
         {
-            logs_dbg("Iterating Platform Config file: %s\n",
-                     file.path().c_str());
-            platform_config::Config platformConfig;
+            backend = &replay.emplace(configuration.replayFile,
+                                      configuration.replayTiming);
+        }
+        else if (!configuration.captureFile.empty())
+        {
+            backend = &recorder.emplace(system);
+        }
 
-            if (!platformConfig.loadFromFile(file.path()))
+        match = matcher.evaluate(*backend);
+        if (recorder)
+        {
+            try
+            {
+                recorder->save(configuration.captureFile);
+            }
+            catch (const std::exception& e)
             {
-                logs_err("Unable to access Platform Config file: %s\n",
-                         file.path().c_str());
-                continue;
+                logs_err("%s\n", e.what());
             }
+        }
+        logs_dbg("Evaluated platform configurations in %lu us, "
+                 "%lu D-Bus calls, %lu cache hits\n",
+                 match.duration, match.dbusCallCount, match.cacheHits);
+        if (configuration.explain)
+        {
+            std::cout << platform_explain::explain(match,
+                                                   *configuration.explain)
+                      << std::flush;
+        }
+        if (replay)
+        {
+            logs_err("Replayed %s: %s%s\n", configuration.replayFile.c_str(),
+                     match.winner ? match.winner->name.c_str() : "no match",
+                     match.isDefault ? " (default)" : "");
+            return match.winner ? 0 : 1;
+        }
 
-            if (platformConfig.performChecks())
+        if (match.winner && !match.isDefault)
+        {
+            rc = applyPlatformConfig(*match.winner);
+            if (rc == 0)
             {
-                int rc = platformConfig.performActions();
-                if (rc != 0)
-                {
-                    break;
-                }
                 logs_err(
                     "Successfully loaded platform configuration: %s, Exiting.\n",
-                    platformConfig.name.c_str());
-                return 0;
+                    match.winner->name.c_str());
+                return runResident(matcher, makeResult(*match.winner, match));
             }
         }
     }
     catch (const std::exception& e)
     {
         logs_err("Exception occurred: %s\n", e.what());
+        if (!configuration.replayFile.empty())
+        {
+            // Never fall back to acting on this machine
+            return 1;
+        }
     }
 
     // If we are here, that means None of the Platform Configuration File
     // matched the current running platform We would load Default Platform
     // Configuration File
-    platform_config::Config defaultPlatformConfig;
-
-    logs_dbg("Loading Default platform configuration file: %s\n",
-             PCM_DEFAULT_PLATFORM_CONF_FILE.c_str());
+    auto defaultPlatformConfig = matcher.getDefaultConfig();
+    if (!defaultPlatformConfig)
+    {
+        logs_err(
+            "Unable to access Default platform config file: %s. Expect system to be in degraded state.\n",
+            PCM_DEFAULT_PLATFORM_CONF_FILE.c_str());
+        return 1;
+    }
 
     try
     {
-        if (!defaultPlatformConfig.loadFromFile(PCM_DEFAULT_PLATFORM_CONF_FILE))
+        // Already counted by the evaluation when nothing matched
+        if (!match.isDefault)
         {
-            logs_err(
-                "Unable to access Default platform config file: %s. Expect system to be in degraded state.\n",
-                PCM_DEFAULT_PLATFORM_CONF_FILE.c_str());
-            return 1;
+            pcm_metrics::defaultConfigUsed.inc();
         }
-        rc = defaultPlatformConfig.performActions();
+        rc = applyPlatformConfig(*defaultPlatformConfig,
+                                 pcm_shm::Status::defaulted);
         if (rc != 0)
         {
             logs_err(
@@ -274,6 +903,6 @@ int main(int argc, char* argv[])
 
     logs_err(
         "Successfully loaded default platform configuration: %s, Exiting.\n",
-        defaultPlatformConfig.name.c_str());
-    return 0;
+        defaultPlatformConfig->name.c_str());
+    return runResident(matcher, makeResult(*defaultPlatformConfig, match));
 }
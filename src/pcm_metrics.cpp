@@ -0,0 +1,230 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pcm_metrics.hpp"
+
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace pcm_metrics
+{
+
+namespace
+{
+
+/** Registry in definition order, constant initialized before any metric */
+constinit const Metric* head = nullptr;
+constinit Metric* tail = nullptr;
+
+/** LabeledCounter::Slot::size while a value is being copied */
+constexpr size_t filling = SIZE_MAX;
+
+void appendLabelValue(fmt::memory_buffer& out, std::string_view value)
+{
+    for (char c : value)
+    {
+        if (c == '\\' || c == '"')
+        {
+            out.push_back('\\');
+            out.push_back(c);
+        }
+        else if (c == '\n')
+        {
+            out.push_back('\\');
+            out.push_back('n');
+        }
+        else
+        {
+            out.push_back(c);
+        }
+    }
+}
+
+} // namespace
+
+Metric::Metric(const char* name, const char* help, const char* type) :
+    name(name), help(help), type(type)
+{
+    // Metrics are globals, constructed before main() by a single thread
+    if (tail != nullptr)
+    {
+        tail->next = this;
+    }
+    else
+    {
+        head = this;
+    }
+    tail = this;
+}
+
+void Counter::writeSamples(fmt::memory_buffer& out) const
+{
+    fmt::format_to(fmt::appender(out), "{} {}\n", name, get());
+}
+
+void Gauge::writeSamples(fmt::memory_buffer& out) const
+{
+    fmt::format_to(fmt::appender(out), "{} {}\n", name, get());
+}
+
+LabeledCounter::Slot& LabeledCounter::slot(std::string_view value)
+{
+    value = value.substr(0, maxValueSize);
+    // Sizes are stored + 1, 0 marks a free slot
+    size_t size = value.size() + 1;
+    for (auto& slot : slots)
+    {
+        auto current = slot.size.load(std::memory_order_acquire);
+        if (current == 0)
+        {
+            if (slot.size.compare_exchange_strong(current, filling,
+                                                  std::memory_order_acquire))
+            {
+                memcpy(slot.value, value.data(), value.size());
+                slot.size.store(size, std::memory_order_release);
+                return slot;
+            }
+        }
+        while (current == filling)
+        {
+            current = slot.size.load(std::memory_order_acquire);
+        }
+        if (current == size && memcmp(slot.value, value.data(), size - 1) == 0)
+        {
+            return slot;
+        }
+    }
+    return other;
+}
+
+void LabeledCounter::writeSamples(fmt::memory_buffer& out) const
+{
+    auto sample = [this, &out](std::string_view value, uint64_t count) {
+        fmt::format_to(fmt::appender(out), "{}{{{}=\"", name, label);
+        appendLabelValue(out, value);
+        fmt::format_to(fmt::appender(out), "\"}} {}\n", count);
+    };
+
+    for (const auto& slot : slots)
+    {
+        auto size = slot.size.load(std::memory_order_acquire);
+        if (size == 0 || size == filling)
+        {
+            continue;
+        }
+        sample({slot.value, size - 1},
+               slot.count.load(std::memory_order_relaxed));
+    }
+    if (auto count = other.count.load(std::memory_order_relaxed))
+    {
+        sample("other", count);
+    }
+}
+
+Histogram::Histogram(const char* name, const char* help,
+                     std::initializer_list<uint64_t> boundsUs) :
+    Metric(name, help, "histogram")
+{
+    for (auto bound : boundsUs)
+    {
+        if (boundCount < maxBuckets)
+        {
+            bounds[boundCount++] = bound;
+        }
+    }
+}
+
+void Histogram::writeSamples(fmt::memory_buffer& out) const
+{
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= boundCount; i++)
+    {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        if (i < boundCount)
+        {
+            fmt::format_to(fmt::appender(out), "{}_bucket{{le=\"{}\"}} {}\n",
+                           name, bounds[i] / 1e6, cumulative);
+        }
+        else
+        {
+            fmt::format_to(fmt::appender(out),
+                           "{}_bucket{{le=\"+Inf\"}} {}\n", name, cumulative);
+        }
+    }
+    fmt::format_to(fmt::appender(out), "{}_sum {}\n{}_count {}\n", name,
+                   sumUs.load(std::memory_order_relaxed) / 1e6, name,
+                   cumulative);
+}
+
+LabeledCounter dbusCalls("pcm_dbus_calls_total",
+                         "D-Bus method calls made by pcmd.", "service");
+LabeledCounter dbusFailures("pcm_dbus_failures_total",
+                            "D-Bus method calls which failed.", "service");
+Histogram dbusLatency("pcm_dbus_call_duration_seconds",
+                      "Duration of the D-Bus method calls.",
+                      {100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+                       100000, 250000, 1000000});
+
+Counter evaluations("pcm_evaluations_total",
+                    "Evaluations of the platform configurations.");
+Histogram detectionLatency("pcm_detection_duration_seconds",
+                           "Duration of the evaluations of the platform "
+                           "configurations.",
+                           {1000, 5000, 10000, 25000, 50000, 100000, 250000,
+                            500000, 1000000, 2500000, 5000000, 10000000});
+Counter cacheHits("pcm_cache_hits_total",
+                  "D-Bus requests answered by the evaluation cache.");
+Counter cacheMisses("pcm_cache_misses_total",
+                    "D-Bus requests forwarded by the evaluation cache.");
+Counter defaultConfigUsed("pcm_default_config_total",
+                          "Evaluations where no platform configuration "
+                          "matched, and fallbacks to the default one.");
+
+LabeledCounter checks("pcm_checks_total", "Platform checks performed.",
+                      "result");
+LabeledCounter::Handle checksPassed = checks.handle("passed");
+LabeledCounter::Handle checksFailed = checks.handle("failed");
+LabeledCounter::Handle checksError = checks.handle("error");
+LabeledCounter actions("pcm_actions_total",
+                       "Platform configurations applied.", "result");
+LabeledCounter::Handle actionsApplied = actions.handle("applied");
+LabeledCounter::Handle actionsFailed = actions.handle("failed");
+
+Gauge configFiles("pcm_config_files", "Platform configurations loaded.");
+
+void render(fmt::memory_buffer& out)
+{
+    for (auto metric = head; metric != nullptr; metric = metric->next)
+    {
+        fmt::format_to(fmt::appender(out), "# HELP {} {}\n# TYPE {} {}\n",
+                       metric->name, metric->help, metric->name,
+                       metric->type);
+        metric->writeSamples(out);
+    }
+}
+
+bool write(const std::string& file)
+{
+    fmt::memory_buffer out;
+    render(out);
+
+    return utils::writeFileAtomically(file, {out.data(), out.size()});
+}
+
+} // namespace pcm_metrics
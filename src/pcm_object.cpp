@@ -0,0 +1,133 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pcm_object.hpp"
+
+#include "log.hpp"
+
+namespace pcm_object
+{
+
+namespace
+{
+
+template <typename T>
+int appendReply(sd_bus_message* reply, const T& value)
+{
+    try
+    {
+        auto m = sdbusplus::message::message(reply);
+        m.append(value);
+    }
+    catch (const std::exception& e)
+    {
+        logs_err("Exception occurred while appending property reply: %s\n",
+                 e.what());
+        return -EINVAL;
+    }
+    return 1;
+}
+
+} // namespace
+
+const sdbusplus::vtable::vtable_t ResultObject::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property("Name", "s", ResultObject::getName,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property("ConfigFile", "s", ResultObject::getConfigFile,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property("EvaluationDuration", "t",
+                                ResultObject::getEvaluationDuration,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property("DBusCallCount", "t",
+                                ResultObject::getDBusCallCount,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property("MatchedChecks", "as",
+                                ResultObject::getMatchedChecks,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::end()};
+
+ResultObject::ResultObject(sdbusplus::bus::bus& bus, const char* path) :
+    intf(bus, path, dbus::interface::pcmResult, vtable, this)
+{}
+
+void ResultObject::update(const Result& newResult)
+{
+    Result previous = std::move(this->result);
+    this->result = newResult;
+
+    if (previous.name != result.name)
+    {
+        intf.property_changed("Name");
+    }
+    if (previous.configFile != result.configFile)
+    {
+        intf.property_changed("ConfigFile");
+    }
+    if (previous.evaluationDuration != result.evaluationDuration)
+    {
+        intf.property_changed("EvaluationDuration");
+    }
+    if (previous.dbusCallCount != result.dbusCallCount)
+    {
+        intf.property_changed("DBusCallCount");
+    }
+    if (previous.matchedChecks != result.matchedChecks)
+    {
+        intf.property_changed("MatchedChecks");
+    }
+}
+
+int ResultObject::getName(sd_bus*, const char*, const char*, const char*,
+                          sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    return appendReply(reply, static_cast<ResultObject*>(context)->result.name);
+}
+
+int ResultObject::getConfigFile(sd_bus*, const char*, const char*, const char*,
+                                sd_bus_message* reply, void* context,
+                                sd_bus_error*)
+{
+    return appendReply(reply,
+                       static_cast<ResultObject*>(context)->result.configFile);
+}
+
+int ResultObject::getEvaluationDuration(sd_bus*, const char*, const char*,
+                                        const char*, sd_bus_message* reply,
+                                        void* context, sd_bus_error*)
+{
+    return appendReply(
+        reply, static_cast<ResultObject*>(context)->result.evaluationDuration);
+}
+
+int ResultObject::getDBusCallCount(sd_bus*, const char*, const char*,
+                                   const char*, sd_bus_message* reply,
+                                   void* context, sd_bus_error*)
+{
+    return appendReply(
+        reply, static_cast<ResultObject*>(context)->result.dbusCallCount);
+}
+
+int ResultObject::getMatchedChecks(sd_bus*, const char*, const char*,
+                                   const char*, sd_bus_message* reply,
+                                   void* context, sd_bus_error*)
+{
+    return appendReply(
+        reply, static_cast<ResultObject*>(context)->result.matchedChecks);
+}
+
+} // namespace pcm_object
@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pcm_reload.hpp"
+
+#include "log.hpp"
+
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace pcm_reload
+{
+
+namespace
+{
+constexpr uint32_t watchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                               IN_DELETE;
+} // namespace
+
+Reloader::Reloader(sdeventplus::Event& event,
+                   platform_matcher::PlatformMatcher& matcher,
+                   std::chrono::milliseconds debounce, Callback callback) :
+    matcher(matcher),
+    debounce(debounce), callback(std::move(callback)),
+    timer(event, [this](auto&) { onQuiet(); })
+{
+    timer.setEnabled(false);
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (-1 == fd)
+    {
+        throw std::runtime_error("inotify init failed (" +
+                                 std::string(strerror(errno)) + ")!");
+    }
+
+    confWd = inotify_add_watch(fd, matcher.getConfPath().c_str(), watchMask);
+    if (-1 == confWd)
+    {
+        logs_err("Unable to watch %s: %s\n", matcher.getConfPath().c_str(),
+                 strerror(errno));
+    }
+    auto dataDir = fs::path(matcher.getDefaultFile()).parent_path();
+    dataWd = inotify_add_watch(fd, dataDir.c_str(), watchMask);
+    if (-1 == dataWd)
+    {
+        logs_err("Unable to watch %s: %s\n", dataDir.c_str(), strerror(errno));
+    }
+
+    io.emplace(event, fd, EPOLLIN,
+               [this](sdeventplus::source::IO&, int, uint32_t) { onEvent(); });
+}
+
+Reloader::~Reloader()
+{
+    io.reset();
+    close(fd);
+}
+
+void Reloader::onEvent()
+{
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t len = 0;
+    while ((len = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char* ptr = buffer; ptr < buffer + len;
+             ptr += sizeof(struct inotify_event) +
+                    reinterpret_cast<struct inotify_event*>(ptr)->len)
+        {
+            auto event = reinterpret_cast<struct inotify_event*>(ptr);
+            if (event->len == 0)
+            {
+                continue;
+            }
+
+            std::string file;
+            if (event->wd == confWd)
+            {
+                file = matcher.getConfPath() + event->name;
+            }
+            else if (event->wd == dataWd)
+            {
+                file = (fs::path(matcher.getDefaultFile()).parent_path() /
+                        event->name)
+                           .string();
+                if (file != matcher.getDefaultFile())
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                continue;
+            }
+            logs_dbg("Platform configuration file changed: %s\n",
+                     file.c_str());
+            pending.insert(std::move(file));
+        }
+    }
+
+    // Every new change extends the burst
+    if (!pending.empty())
+    {
+        timer.restartOnce(debounce);
+    }
+}
+
+void Reloader::onQuiet()
+{
+    std::vector<std::string> files(pending.begin(), pending.end());
+    pending.clear();
+
+    logs_dbg("Reloading %zu platform configuration files\n", files.size());
+    if (matcher.reload(files))
+    {
+        callback();
+    }
+}
+
+} // namespace pcm_reload
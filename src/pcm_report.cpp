@@ -0,0 +1,187 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pcm_report.hpp"
+
+#include "utils.hpp"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <ctime>
+
+namespace pcm_report
+{
+
+namespace
+{
+
+struct Totals
+{
+    std::atomic<int64_t> count{0};
+    std::atomic<int64_t> wall{0};
+    std::atomic<int64_t> cpu{0};
+    std::atomic<int64_t> minorFaults{0};
+    std::atomic<int64_t> majorFaults{0};
+    std::atomic<int64_t> maxRss{0};
+};
+
+std::atomic<bool> enabled{true};
+std::array<Totals, static_cast<size_t>(Phase::count)> totals;
+thread_local Scope* current = nullptr;
+
+int64_t toUs(const struct timeval& tv)
+{
+    return tv.tv_sec * 1000000ll + tv.tv_usec;
+}
+
+int64_t monotonicUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ll + ts.tv_nsec / 1000;
+}
+
+Scope::Sample sample(int who = RUSAGE_THREAD)
+{
+    struct rusage usage
+    {};
+    getrusage(who, &usage);
+    return {monotonicUs(), toUs(usage.ru_utime) + toUs(usage.ru_stime),
+            usage.ru_minflt, usage.ru_majflt, usage.ru_maxrss};
+}
+
+void updateMax(std::atomic<int64_t>& max, int64_t value)
+{
+    auto prev = max.load(std::memory_order_relaxed);
+    while (prev < value &&
+           !max.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+    {}
+}
+
+/** Start of the run, taken when pcmlib is loaded */
+const int64_t runBegin = monotonicUs();
+
+void appendUsage(fmt::memory_buffer& out, int64_t wall, int64_t cpu,
+                 int64_t minorFaults, int64_t majorFaults, int64_t maxRss)
+{
+    fmt::format_to(fmt::appender(out),
+                   "\"wall_us\":{},\"cpu_us\":{},\"minor_faults\":{},"
+                   "\"major_faults\":{},\"peak_rss_kb\":{}",
+                   wall, cpu, minorFaults, majorFaults, maxRss);
+}
+
+} // namespace
+
+void setEnabled(bool enable)
+{
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+Scope::Scope(Phase phase) : phase(phase)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    active = true;
+    start = sample();
+    parent = current;
+    if (parent != nullptr)
+    {
+        parent->charge(start);
+    }
+    current = this;
+}
+
+Scope::~Scope()
+{
+    if (!active)
+    {
+        return;
+    }
+    auto now = sample();
+    charge(now);
+    totals[static_cast<size_t>(phase)].count.fetch_add(
+        1, std::memory_order_relaxed);
+    current = parent;
+    if (parent != nullptr)
+    {
+        // The enclosing phase resumes
+        parent->start = now;
+    }
+}
+
+void Scope::charge(const Sample& now)
+{
+    auto& total = totals[static_cast<size_t>(phase)];
+    total.wall.fetch_add(now.wall - start.wall, std::memory_order_relaxed);
+    total.cpu.fetch_add(now.cpu - start.cpu, std::memory_order_relaxed);
+    total.minorFaults.fetch_add(now.minorFaults - start.minorFaults,
+                                std::memory_order_relaxed);
+    total.majorFaults.fetch_add(now.majorFaults - start.majorFaults,
+                                std::memory_order_relaxed);
+    updateMax(total.maxRss, now.maxRss);
+}
+
+std::array<int64_t, static_cast<size_t>(Phase::count)> wallTimes()
+{
+    std::array<int64_t, static_cast<size_t>(Phase::count)> times;
+    for (size_t i = 0; i < totals.size(); i++)
+    {
+        times[i] = totals[i].wall.load(std::memory_order_relaxed);
+    }
+    return times;
+}
+
+bool write(const std::string& file)
+{
+    auto run = sample(RUSAGE_SELF);
+
+    fmt::memory_buffer out;
+    fmt::format_to(fmt::appender(out), "{{\"version\":1,\"pid\":{},\"run\":{{",
+                   getpid());
+    appendUsage(out, run.wall - runBegin, run.cpu, run.minorFaults,
+                run.majorFaults, run.maxRss);
+    fmt::format_to(fmt::appender(out), "}},\"phases\":{{");
+    for (size_t i = 0; i < totals.size(); i++)
+    {
+        const auto& total = totals[i];
+        fmt::format_to(fmt::appender(out), "{}\"{}\":{{\"count\":{},",
+                       i ? "," : "", phaseNames[i],
+                       total.count.load(std::memory_order_relaxed));
+        appendUsage(out, total.wall.load(std::memory_order_relaxed),
+                    total.cpu.load(std::memory_order_relaxed),
+                    total.minorFaults.load(std::memory_order_relaxed),
+                    total.majorFaults.load(std::memory_order_relaxed),
+                    total.maxRss.load(std::memory_order_relaxed));
+        out.push_back('}');
+    }
+    fmt::format_to(fmt::appender(out), "}}}}\n");
+
+    return utils::writeFileAtomically(file, {out.data(), out.size()});
+}
+
+} // namespace pcm_report
@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pcm_shm.hpp"
+
+#include "log.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace pcm_shm
+{
+
+namespace
+{
+
+void copyString(char* dst, size_t size, std::string_view src)
+{
+    auto len = std::min(src.size(), size - 1);
+    std::memcpy(dst, src.data(), len);
+    std::memset(dst + len, 0, size - len);
+}
+
+} // namespace
+
+Writer::Writer(const char* name)
+{
+    smfd = shm_open(name, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP |
+                                                S_IROTH);
+    if (-1 == smfd)
+    {
+        throw std::runtime_error("Result SMEM open failed (" +
+                                 std::string(strerror(errno)) + ")!");
+    }
+
+    int rc = ftruncate(smfd, sizeof(Block));
+    if (-1 == rc)
+    {
+        close(smfd);
+        throw std::runtime_error("Result SMEM truncate failed!");
+    }
+
+    void* addr = mmap(NULL, sizeof(Block), PROT_READ | PROT_WRITE, MAP_SHARED,
+                      smfd, 0);
+    if (addr == MAP_FAILED)
+    {
+        close(smfd);
+        throw std::runtime_error("Result SMEM map failed!");
+    }
+    block = static_cast<Block*>(addr);
+
+    // A new or incompatible block starts over from generation 0
+    if (block->magic != SHM_MAGIC || block->version != SHM_VERSION)
+    {
+        logs_dbg("Initializing result SMEM %s\n", name);
+        block->sequence.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        block->magic = SHM_MAGIC;
+        block->version = SHM_VERSION;
+        std::memset(&block->data, 0, sizeof(block->data));
+        block->generation.store(0, std::memory_order_relaxed);
+        block->sequence.store(2, std::memory_order_release);
+    }
+    else if (block->sequence.load(std::memory_order_relaxed) & 1)
+    {
+        // A previous writer died in the middle of an update
+        block->sequence.fetch_add(1, std::memory_order_release);
+    }
+}
+
+Writer::~Writer()
+{
+    munmap(block, sizeof(Block));
+    close(smfd);
+}
+
+uint32_t Writer::publish(const std::string& name, Status status,
+                         const std::vector<std::string>& variables)
+{
+    // Truncated strings would be silently wrong for readers, and nothing
+    // is logged while the sequence is odd and readers wait
+    if (name.size() >= NAME_SIZE)
+    {
+        throw std::runtime_error("Platform name too long for result SMEM: " +
+                                 name);
+    }
+
+    std::vector<std::pair<std::string_view, std::string_view>> entries;
+    std::vector<const std::string*> dropped;
+    entries.reserve(std::min(variables.size(), MAX_ENV));
+    for (const auto& variable : variables)
+    {
+        std::string_view key(variable);
+        std::string_view value;
+        auto pos = key.find('=');
+        if (pos != std::string_view::npos)
+        {
+            value = key.substr(pos + 1);
+            key = key.substr(0, pos);
+        }
+        if (entries.size() >= MAX_ENV || key.size() >= KEY_SIZE ||
+            value.size() >= VALUE_SIZE)
+        {
+            dropped.push_back(&variable);
+            continue;
+        }
+        entries.emplace_back(key, value);
+    }
+
+    auto seq = block->sequence.load(std::memory_order_relaxed);
+    block->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto& data = block->data;
+    data.generation++;
+    data.status = status;
+    copyString(data.name, sizeof(data.name), name);
+    data.envCount = entries.size();
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        copyString(data.env[i].key, sizeof(data.env[i].key), entries[i].first);
+        copyString(data.env[i].value, sizeof(data.env[i].value),
+                   entries[i].second);
+    }
+
+    block->generation.store(data.generation, std::memory_order_relaxed);
+    block->sequence.store(seq + 2, std::memory_order_release);
+
+    for (const auto* variable : dropped)
+    {
+        logs_err("Variable does not fit in result SMEM (at most %zu, keys "
+                 "up to %zu and values up to %zu bytes), dropping: %s\n",
+                 MAX_ENV, KEY_SIZE - 1, VALUE_SIZE - 1, variable->c_str());
+    }
+    return data.generation;
+}
+
+} // namespace pcm_shm
@@ -0,0 +1,395 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pcm_watch.hpp"
+
+#include "dbus_accessor.hpp"
+#include "log.hpp"
+
+#include <sdbusplus/message/types.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+namespace pcm_watch
+{
+
+namespace
+{
+constexpr auto objectManager = "org.freedesktop.DBus.ObjectManager";
+} // namespace
+
+Watcher::Watcher(sdbusplus::bus::bus& bus, sdeventplus::Event& event,
+                 const platform_matcher::PlatformMatcher& matcher,
+                 dbus::Backend& backend, const std::string& winner,
+                 Callback callback) :
+    bus(bus),
+    matcher(matcher), backend(backend), winner(winner),
+    callback(std::move(callback)),
+    configSet(matcher.getConfigSet()),
+    deferred(event, [this](sdeventplus::source::EventBase&) { reevaluate(); })
+{
+    deferred.set_enabled(sdeventplus::source::Enabled::Off);
+
+    // Subscribe first, so no change is lost between evaluation and signals
+    buildDependencies();
+    subscribe();
+    evaluateAll();
+
+    // The applied config may not be the one the checks decide, e.g. when it
+    // was picked from the EnvironmentFile with --skip-checks
+    auto result = getResult();
+    if (result.winner && result.winner->name == this->winner)
+    {
+        winnerConfig = result.winner;
+    }
+    else
+    {
+        deferred.set_enabled(sdeventplus::source::Enabled::OneShot);
+    }
+}
+
+void Watcher::buildDependencies()
+{
+    dependencies.clear();
+    const auto& configs = configSet->configs;
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        for (size_t j = 0; j < configs[i]->checks.size(); j++)
+        {
+            dependencies[configs[i]->checks[j].interface].emplace_back(i, j);
+        }
+    }
+}
+
+void Watcher::subscribe()
+{
+    namespace rules = sdbusplus::bus::match::rules;
+
+    matches.clear();
+    for (const auto& [interface, checks] : dependencies)
+    {
+        logs_dbg("Watching PropertiesChanged for interface %s\n",
+                 interface.c_str());
+        matches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+            bus,
+            rules::type::signal() +
+                rules::interface(dbus::interface::dbusProperty) +
+                rules::member("PropertiesChanged") + rules::argN(0, interface),
+            [this](sdbusplus::message::message& msg) {
+            onPropertiesChanged(msg);
+        }));
+    }
+
+    matches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        rules::type::signal() + rules::interface(objectManager) +
+            rules::member("InterfacesAdded"),
+        [this](sdbusplus::message::message& msg) { onInterfacesAdded(msg); }));
+    matches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        rules::type::signal() + rules::interface(objectManager) +
+            rules::member("InterfacesRemoved"),
+        [this](sdbusplus::message::message& msg) {
+        onInterfacesRemoved(msg);
+    }));
+}
+
+void Watcher::evaluateAll()
+{
+    auto begin = std::chrono::steady_clock::now();
+    dbus::CachedBackend cache(backend);
+
+    const auto& configs = configSet->configs;
+    results.assign(configs.size(), {});
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        results[i].resize(configs[i]->checks.size());
+        for (size_t j = 0; j < configs[i]->checks.size(); j++)
+        {
+            configs[i]->checks[j].performChecks(cache, results[i][j]);
+        }
+    }
+    dirty.clear();
+
+    logs_dbg("Evaluated all checks in %lu us, %lu D-Bus calls\n",
+             std::chrono::duration_cast<std::chrono::microseconds>(
+                 std::chrono::steady_clock::now() - begin)
+                 .count(),
+             cache.getMisses());
+}
+
+platform_matcher::MatchResult Watcher::getResult() const
+{
+    platform_matcher::MatchResult result;
+    const auto& configs = configSet->configs;
+
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        const auto& config = *configs[i];
+        auto& configResult = result.configs.emplace_back();
+        configResult.config = configs[i];
+        configResult.name = config.name;
+        configResult.file = config.file;
+        configResult.evaluated = true;
+        configResult.checks = results[i];
+        configResult.matched = config.matchRule(results[i]);
+        if (configResult.matched)
+        {
+            for (size_t j = 0; j < config.checks.size(); j++)
+            {
+                if (results[i][j].passed)
+                {
+                    configResult.decisiveChecks.push_back(
+                        config.checks[j].describe());
+                }
+            }
+            if (!result.winner)
+            {
+                result.winner = configs[i];
+            }
+        }
+    }
+
+    if (!result.winner)
+    {
+        result.winner = configSet->defaultConfig;
+        result.isDefault = true;
+    }
+    return result;
+}
+
+void Watcher::markDirty(const std::string& path, const std::string& interface,
+                        const std::set<std::string>* properties)
+{
+    auto it = dependencies.find(interface);
+    if (it == dependencies.end())
+    {
+        return;
+    }
+
+    const auto& configs = configSet->configs;
+    for (const auto& id : it->second)
+    {
+        const auto& check = configs[id.first]->checks[id.second];
+        if (properties != nullptr && !properties->contains(check.property))
+        {
+            continue;
+        }
+        // Checks with explicit objects only depend on those
+        if (!check.objects.empty() &&
+            std::find(check.objects.begin(), check.objects.end(), path) ==
+                check.objects.end())
+        {
+            continue;
+        }
+        dirty.insert(id);
+    }
+
+    if (!dirty.empty())
+    {
+        deferred.set_enabled(sdeventplus::source::Enabled::OneShot);
+    }
+}
+
+void Watcher::reevaluate()
+{
+    auto begin = std::chrono::steady_clock::now();
+    dbus::CachedBackend cache(backend);
+
+    const auto& configs = configSet->configs;
+    for (const auto& [config, check] : dirty)
+    {
+        results[config][check] = platform_checks::CheckResult{};
+        configs[config]->checks[check].performChecks(cache,
+                                                     results[config][check]);
+    }
+    logs_dbg("Re-evaluated %zu checks in %lu us, %lu D-Bus calls\n",
+             dirty.size(),
+             std::chrono::duration_cast<std::chrono::microseconds>(
+                 std::chrono::steady_clock::now() - begin)
+                 .count(),
+             cache.getMisses());
+    dirty.clear();
+
+    auto result = getResult();
+    result.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - begin)
+                          .count();
+    result.dbusCallCount = cache.getMisses();
+    result.cacheHits = cache.getHits();
+
+    std::string name = result.winner ? result.winner->name : std::string{};
+    if (name != winner || result.winner != winnerConfig)
+    {
+        logs_err("Platform configuration changed from %s to %s\n",
+                 winner.c_str(), name.c_str());
+        winner = name;
+        winnerConfig = result.winner;
+        callback(result);
+    }
+}
+
+void Watcher::reload()
+{
+    auto next = matcher.getConfigSet();
+    if (next == configSet)
+    {
+        return;
+    }
+
+    // Pending inventory changes refer to the previous set
+    if (!dirty.empty())
+    {
+        reevaluate();
+    }
+
+    // Outcomes of configs shared with the previous set are still valid
+    std::map<const platform_config::Config*,
+             std::vector<platform_checks::CheckResult>>
+        cached;
+    for (size_t i = 0; i < configSet->configs.size(); i++)
+    {
+        cached.emplace(configSet->configs[i].get(), std::move(results[i]));
+    }
+
+    // Any change may take over from the default config
+    bool affectsWinner = !winnerConfig ||
+                         winnerConfig == configSet->defaultConfig;
+
+    dbus::CachedBackend cache(backend);
+    results.assign(next->configs.size(), {});
+    size_t evaluated = 0;
+    for (size_t i = 0; i < next->configs.size(); i++)
+    {
+        const auto& config = next->configs[i];
+        auto it = cached.find(config.get());
+        if (it != cached.end())
+        {
+            results[i] = std::move(it->second);
+            cached.erase(it);
+            continue;
+        }
+
+        // New or changed config, it can only take over from a winner
+        // evaluated after it
+        if (winnerConfig && config->file <= winnerConfig->file)
+        {
+            affectsWinner = true;
+        }
+        results[i].resize(config->checks.size());
+        for (size_t j = 0; j < config->checks.size(); j++)
+        {
+            config->checks[j].performChecks(cache, results[i][j]);
+            evaluated++;
+        }
+    }
+
+    // Configs left over were removed or changed
+    if (cached.contains(winnerConfig.get()))
+    {
+        affectsWinner = true;
+    }
+
+    configSet = std::move(next);
+    buildDependencies();
+    subscribe();
+    dirty.clear();
+
+    logs_dbg("Reloaded configs, evaluated %zu checks, winner %s affected\n",
+             evaluated, affectsWinner ? "may be" : "is not");
+    if (affectsWinner)
+    {
+        reevaluate();
+    }
+}
+
+void Watcher::onPropertiesChanged(sdbusplus::message::message& msg)
+{
+    std::string path = msg.get_path();
+    std::string interface;
+    std::map<std::string, dbus::DBusValue> changed;
+    try
+    {
+        msg.read(interface, changed);
+    }
+    catch (const std::exception& e)
+    {
+        // A value of a type we do not know, consider every property changed
+        logs_dbg("Unable to decode PropertiesChanged on %s: %s\n",
+                 path.c_str(), e.what());
+        if (!interface.empty())
+        {
+            markDirty(path, interface, nullptr);
+        }
+        return;
+    }
+
+    std::set<std::string> properties;
+    for (const auto& [property, value] : changed)
+    {
+        properties.insert(property);
+    }
+    markDirty(path, interface, &properties);
+}
+
+void Watcher::onInterfacesAdded(sdbusplus::message::message& msg)
+{
+    sdbusplus::message::object_path path;
+    std::map<std::string, std::map<std::string, dbus::DBusValue>> interfaces;
+    try
+    {
+        msg.read(path, interfaces);
+    }
+    catch (const std::exception& e)
+    {
+        // Cannot tell which interfaces were added, so re-evaluate them all
+        logs_dbg("Unable to decode InterfacesAdded: %s\n", e.what());
+        for (const auto& [interface, checks] : dependencies)
+        {
+            markDirty(path, interface, nullptr);
+        }
+        return;
+    }
+
+    for (const auto& [interface, properties] : interfaces)
+    {
+        markDirty(path, interface, nullptr);
+    }
+}
+
+void Watcher::onInterfacesRemoved(sdbusplus::message::message& msg)
+{
+    sdbusplus::message::object_path path;
+    std::vector<std::string> interfaces;
+    try
+    {
+        msg.read(path, interfaces);
+    }
+    catch (const std::exception& e)
+    {
+        logs_dbg("Unable to decode InterfacesRemoved: %s\n", e.what());
+        return;
+    }
+
+    for (const auto& interface : interfaces)
+    {
+        markDirty(path, interface, nullptr);
+    }
+}
+
+} // namespace pcm_watch
@@ -15,10 +15,13 @@
  * limitations under the License.
  */
 
+#define LOG_CATEGORY actions
+
 #include "platform_actions.hpp"
 
 #include "constants.hpp"
 #include "log.hpp"
+#include "log_trace.hpp"
 
 #include <filesystem>
 #include <fstream>
@@ -30,24 +33,23 @@ namespace fs = std::filesystem;
 namespace platform_actions
 {
 
-int Actions_t::performActions(const std::string& name, bool& fileCreated)
+int Actions_t::performActions(const std::string& name, bool& fileCreated,
+                              const std::string& envPath) const
 {
+    trace_span("actions", "write", envPath);
     int rc = 0;
     // Open default Environment File
     std::ofstream envFile;
     if (fileCreated)
     {
-        logs_dbg("Opening Environment File: %s\n",
-                 constants::PCM_ENV_FILE.c_str());
-        envFile.open(constants::PCM_ENV_FILE,
-                     std::ofstream::out | std::ofstream::app);
+        logs_dbg("Opening Environment File: %s\n", envPath.c_str());
+        envFile.open(envPath, std::ofstream::out | std::ofstream::app);
     }
     else
     {
         logs_dbg("Creating and Opening Environment File: %s\n",
-                 constants::PCM_ENV_FILE.c_str());
-        envFile.open(constants::PCM_ENV_FILE,
-                     std::ofstream::out | std::ofstream::trunc);
+                 envPath.c_str());
+        envFile.open(envPath, std::ofstream::out | std::ofstream::trunc);
         fileCreated = true;
 
         // set the permission of the file to 664
@@ -58,12 +60,11 @@ int Actions_t::performActions(const std::string& name, bool& fileCreated)
         fs::perms permission = fs::perms::owner_write | fs::perms::owner_read |
                                fs::perms::group_read | fs::perms::group_write |
                                fs::perms::others_read;
-        fs::permissions(constants::PCM_ENV_FILE, permission);
+        fs::permissions(envPath, permission);
     }
     if (!envFile.good())
     {
-        logs_err("Failed to open Environment File: %s\n",
-                 constants::PCM_ENV_FILE.c_str());
+        logs_err("Failed to open Environment File: %s\n", envPath.c_str());
         return 1;
     }
 
@@ -15,13 +15,18 @@
  * limitations under the License.
  */
 
+#define LOG_CATEGORY checks
+
 #include "platform_checks.hpp"
 
 #include "constants.hpp"
+#include "dbus_accessor.hpp"
 #include "log.hpp"
+#include "pcm_metrics.hpp"
 
 #include <boost/algorithm/string.hpp>
 
+#include <chrono>
 #include <map>
 #include <string>
 #include <vector>
@@ -29,52 +34,68 @@
 namespace platform_checks
 {
 
-bool Checks_t::performChecks()
+bool Checks_t::performChecks(dbus::Backend& backend, CheckResult& result) const
 {
-    if (this->rule == "")
-    {
-        this->rule = constants::MATCH_ALL;
-    }
+    log_field("PCM_INTERFACE", this->interface);
+    log_field("PCM_PROPERTY", this->property);
+    auto begin = std::chrono::steady_clock::now();
+    auto rule = this->rule.empty() ? std::string{constants::MATCH_ALL}
+                                   : this->rule;
 
-    logs_dbg("Rule: %s\n", this->rule.c_str());
+    logs_dbg("Rule: %s\n", rule.c_str());
 
-    if (!readAllPropertiesForInterface())
+    result.passed = false;
+    bool read = readAllPropertiesForInterface(backend, result);
+    if (!read)
     {
         logs_err("Failed to read properties for interface=%s\n",
                  this->interface.c_str());
-        return false;
     }
-
-    std::string rule = boost::algorithm::to_lower_copy(this->rule);
-
-    if (rule == constants::MATCH_ALL)
-    {
-        return this->performCheckMatchAll();
-    }
-    if (rule == constants::MATCH_ONE)
+    else
     {
-        return this->performCheckMatchAny();
+        boost::algorithm::to_lower(rule);
+
+        if (rule == constants::MATCH_ALL)
+        {
+            result.passed = this->performCheckMatchAll(result);
+        }
+        else if (rule == constants::MATCH_ONE)
+        {
+            result.passed = this->performCheckMatchAny(result);
+        }
+        else
+        {
+            logs_err("Invalid Check Rule: %s\n", this->rule.c_str());
+            result.reason = "Invalid check rule " + this->rule;
+        }
     }
 
-    logs_err("Invalid Check Rule: %s\n", this->rule.c_str());
-    return false;
+    result.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - begin)
+                          .count();
+    auto& counter = !read ? pcm_metrics::checksError
+                          : (result.passed ? pcm_metrics::checksPassed
+                                           : pcm_metrics::checksFailed);
+    counter.inc();
+    return result.passed;
 }
 
-bool Checks_t::performCheckMatchAll()
+bool Checks_t::performCheckMatchAll(CheckResult& result) const
 {
     logs_dbg("Performing check Match All\n");
     dbus::DBusValue valueCheck = this->value;
-    for (const auto& dbusValue : this->dbusPropertyValues)
+    for (size_t i = 0; i < result.values.size(); i++)
     {
-        logs_dbg("Matching. Value: %s to D-Bus value: %s\n",
-                 std::get<0>(valueCheck).c_str(),
-                 std::get<0>(dbusValue).c_str());
+        const auto& dbusValue = result.values[i];
+        logs_dbg_dump("Matching. Value: %s to D-Bus value: %s\n",
+                      this->value.c_str(), dbus::toString(dbusValue).c_str());
         if (dbusValue != valueCheck)
         {
             logs_dbg(
                 "Matching failed. Value %s does not match D-Bus value %s\n",
-                std::get<0>(valueCheck).c_str(),
-                std::get<0>(dbusValue).c_str());
+                this->value.c_str(), dbus::toString(dbusValue).c_str());
+            result.reason = "Value of " + result.objects[i] + " is " +
+                            dbus::toString(dbusValue);
             return false;
         }
     }
@@ -82,52 +103,55 @@ bool Checks_t::performCheckMatchAll()
     return true;
 }
 
-bool Checks_t::performCheckMatchAny()
+bool Checks_t::performCheckMatchAny(CheckResult& result) const
 {
     logs_dbg("Performing check Match Any.\n");
     dbus::DBusValue valueCheck = this->value;
-    for (const auto& dbusValue : this->dbusPropertyValues)
+    for (const auto& dbusValue : result.values)
     {
-        logs_dbg("Matching. Value: %s to D-Bus value: %s\n",
-                 std::get<0>(valueCheck).c_str(),
-                 std::get<0>(dbusValue).c_str());
+        logs_dbg_dump("Matching. Value: %s to D-Bus value: %s\n",
+                      this->value.c_str(), dbus::toString(dbusValue).c_str());
         if (dbusValue == valueCheck)
         {
-            logs_dbg("D-Bus Value %s match value %s\n",
-                     std::get<0>(valueCheck).c_str(),
-                     std::get<0>(dbusValue).c_str());
+            logs_dbg("D-Bus Value %s match value %s\n", this->value.c_str(),
+                     dbus::toString(dbusValue).c_str());
             return true;
         }
     }
     logs_dbg("Matching failed. No D-Bus values match.\n");
+    result.reason = "No D-Bus value matches";
     return false;
 }
 
-bool Checks_t::readAllPropertiesForInterface()
+bool Checks_t::readAllPropertiesForInterface(dbus::Backend& backend,
+                                             CheckResult& result) const
 {
     auto serviceName = dbus::service_name::fruManager;
-    if (this->objects.empty())
+    result.objects = this->objects;
+    result.values.clear();
+    if (result.objects.empty())
     {
-        dbus::DBusSubTree subTree;
+        dbus::DBusSubTreePtr subTree;
         logs_dbg(
             "No objects found in platform config file. Searching D-Bus objects for interface %s.\n",
             this->interface.c_str());
         try
         {
-            subTree = dbus::getSubTree(this->interface);
+            subTree = backend.getSubTree(this->interface);
         }
         catch (const std::exception& e)
         {
             logs_err(
                 "Exception occurred while running D-Bus GetSubTree for interface %s. Exception: %s\n",
                 this->interface.c_str(), e.what());
+            result.reason = std::string{"GetSubTree failed: "} + e.what();
             return false;
         }
 
         logs_dbg("Read object mapper SubTree success.\n");
-        for (const auto& objectAndService : subTree)
+        for (const auto& objectAndService : *subTree)
         {
-            std::string objectPath = objectAndService.first;
+            const std::string& objectPath = objectAndService.first;
             const auto& serviceAndInterface = objectAndService.second;
 
             for (const auto& [service, interfaces] : serviceAndInterface)
@@ -138,34 +162,37 @@ bool Checks_t::readAllPropertiesForInterface()
                 {
                     logs_dbg("D-Bus Object Path: %s is valid.\n",
                              objectPath.c_str());
-                    this->objects.push_back(objectPath);
+                    result.objects.push_back(objectPath);
                     break;
                 }
                 else if (service == dbus::service_name::nsmd)
                 {
                     logs_dbg("D-Bus Object Path: %s is valid.\n",
                              objectPath.c_str());
-                    this->objects.push_back(objectPath);
+                    result.objects.push_back(objectPath);
                     serviceName = dbus::service_name::nsmd;
                     break;
                 }
             }
         }
     }
-    if (this->objects.empty())
+    if (result.objects.empty())
     {
         logs_dbg("No D-Bus objects found for interface: %s\n",
                  this->interface.c_str());
+        result.reason = "No D-Bus objects found";
         return false;
     }
 
-    for (const auto& objectPath : this->objects)
+    log_field("PCM_DBUS_SERVICE", serviceName);
+    result.values.reserve(result.objects.size());
+    for (const auto& objectPath : result.objects)
     {
         dbus::DBusValue value;
         try
         {
-            dbus::getProperty(serviceName, objectPath, this->interface,
-                              this->property, value);
+            backend.getProperty(serviceName, objectPath, this->interface,
+                                this->property, value);
         }
         catch (const std::exception& e)
         {
@@ -173,13 +200,15 @@ bool Checks_t::readAllPropertiesForInterface()
                 "Exception occurred while running D-Bus Get-Property for Service:%s, ObjectPath:%s, Interface:%s, Property:%s. Exception: %s\n",
                 serviceName, objectPath.c_str(), this->interface.c_str(),
                 this->property.c_str(), e.what());
+            result.reason = "Get-Property failed on " + objectPath + ": " +
+                            e.what();
             return false;
         }
-        logs_dbg(
+        logs_dbg_dump(
             "Get D-Bus Property, Service:%s, ObjectPath:%s, Interface:%s, Property:%s, Value:%s\n",
             serviceName, objectPath.c_str(), this->interface.c_str(),
-            this->property.c_str(), std::get<0>(value).c_str());
-        this->dbusPropertyValues.push_back(value);
+            this->property.c_str(), dbus::toString(value).c_str());
+        result.values.push_back(std::move(value));
     }
 
     return true;
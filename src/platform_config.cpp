@@ -15,68 +15,115 @@
  * limitations under the License.
  */
 
+#define LOG_CATEGORY config
+
 #include "platform_config.hpp"
 
 #include "constants.hpp"
+#include "dbus_accessor.hpp"
 #include "log.hpp"
+#include "log_trace.hpp"
+#include "pcm_metrics.hpp"
 
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <map>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace platform_config
 {
 
-bool Config::loadFromFile(const std::string& file)
+namespace
 {
-    std::stringstream ss;
-    ss << "loadFromFile func (" << file << ").";
-    logs_dbg("%s\n", ss.str().c_str());
-    std::ifstream i(file);
-    if (!i.good())
+
+/** String value of a node, moved out of it unless the document is const */
+template <typename Json>
+std::string take(Json& value)
+{
+    if constexpr (std::is_const_v<Json>)
     {
-        return false;
+        return value.template get<std::string>();
+    }
+    else
+    {
+        return std::move(value.template get_ref<std::string&>());
     }
-    json j;
-    i >> j;
-
-    loadFrom(j);
-    logs_dbg("Successfully Loaded json:\n%s\n", print().c_str());
-    return true;
 }
 
-void Config::loadFrom(const json& j)
+/** Config::loadFrom() for a const or a temporary document */
+template <typename Json>
+void load(Config& config, Json& j)
 {
-    this->name = j.at("Name");
-    this->rule = j.value("Rule", "");
+    config.name = take(j.at("Name"));
+    auto rule = j.find("Rule");
+    config.rule = (rule != j.end()) ? take(*rule) : "";
 
-    for (auto& check : j.at("Checks"))
+    auto& checks = j.at("Checks");
+    config.checks.reserve(checks.size());
+    for (auto& check : checks)
     {
         platform_checks::Checks_t check_t;
-        check_t.rule = check.value("rule", "");
-        check_t.interface = check.at("interface");
-        check_t.property = check.at("property");
-        check_t.value = check.at("value");
-        for (auto& object : check.at("objects"))
+        auto checkRule = check.find("rule");
+        check_t.rule = (checkRule != check.end()) ? take(*checkRule) : "";
+        check_t.interface = take(check.at("interface"));
+        check_t.property = take(check.at("property"));
+        check_t.value = take(check.at("value"));
+        auto& objects = check.at("objects");
+        check_t.objects.reserve(objects.size());
+        for (auto& object : objects)
         {
-            check_t.objects.push_back(object);
+            check_t.objects.push_back(take(object));
         }
 
-        this->checks.push_back(check_t);
+        config.checks.push_back(std::move(check_t));
     }
 
-    for (auto& action : j.at("Actions"))
+    auto& actions = j.at("Actions");
+    config.actions.reserve(actions.size());
+    for (auto& action : actions)
     {
         platform_actions::Actions_t action_t;
-        for (auto& variable : action.at("variables"))
+        auto& variables = action.at("variables");
+        action_t.variables.reserve(variables.size());
+        for (auto& variable : variables)
         {
-            action_t.variables.push_back(variable);
+            action_t.variables.push_back(take(variable));
         }
-        this->actions.push_back(action_t);
+        config.actions.push_back(std::move(action_t));
+    }
+}
+
+} // namespace
+
+bool Config::loadFromFile(const std::string& file)
+{
+    logs_dbg("loadFromFile func (%s).\n", file.c_str());
+    std::ifstream i(file);
+    if (!i.good())
+    {
+        return false;
     }
+
+    // The document is dropped once loaded, its strings are moved
+    loadFrom(json::parse(i));
+    this->file = file;
+    logs_dbg_dump("Successfully Loaded json:\n%s\n", print().c_str());
+    return true;
+}
+
+void Config::loadFrom(const json& j)
+{
+    load(*this, j);
+}
+
+void Config::loadFrom(json&& j)
+{
+    load(*this, j);
 }
 
 std::string Config::print() const
@@ -99,83 +146,183 @@ std::string Config::print() const
     return ss.str();
 }
 
-bool Config::performChecks()
+bool Config::performChecks(dbus::Backend& backend,
+                           ConfigResult& result) const
 {
+    log_field("PCM_CONFIG", this->name);
     logs_dbg("Perform checks for %s\n", this->name.c_str());
 
-    if (this->rule == "")
-    {
-        this->rule = constants::MATCH_ALL;
-    }
+    auto begin = std::chrono::steady_clock::now();
+    result.name = this->name;
+    result.file = this->file;
+    result.evaluated = true;
+    result.matched = false;
 
-    logs_dbg("Rule: %s\n", this->rule.c_str());
+    auto rule = this->rule.empty() ? std::string{constants::MATCH_ALL}
+                                   : this->rule;
 
-    std::string rule = boost::algorithm::to_lower_copy(this->rule);
+    logs_dbg("Rule: %s\n", rule.c_str());
+
+    boost::algorithm::to_lower(rule);
 
     if (rule == constants::MATCH_ALL)
     {
-        return this->performCheckMatchAll();
+        result.matched = this->performCheckMatchAll(backend, result);
     }
-    if (rule == constants::MATCH_ONE)
+    else if (rule == constants::MATCH_ONE)
     {
-        return this->performCheckMatchAny();
+        result.matched = this->performCheckMatchAny(backend, result);
+    }
+    else
+    {
+        logs_err("Invalid Check Rule: %s\n", this->rule.c_str());
+        result.reason = "Invalid config rule " + this->rule;
     }
 
-    logs_err("Invalid Check Rule: %s\n", this->rule.c_str());
-    return false;
+    result.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - begin)
+                          .count();
+    return result.matched;
 }
 
-bool Config::performCheckMatchAll()
+bool Config::performCheckMatchAll(dbus::Backend& backend,
+                                  ConfigResult& result) const
 {
     logs_dbg("Performing check Match All\n");
-    for (platform_checks::Checks_t& check : this->checks)
+    result.checks.clear();
+    result.decisiveChecks.clear();
+    for (const platform_checks::Checks_t& check : this->checks)
     {
-        if (check.performChecks() == false)
+        auto& checkResult = result.checks.emplace_back();
+        if (check.performChecks(backend, checkResult) == false)
         {
             logs_dbg("Checks did not match for %s\n", this->name.c_str());
+            result.decisiveChecks.clear();
+            result.reason = "MatchAll: " + check.describe() + " failed";
             return false;
         }
+        result.decisiveChecks.push_back(check.describe());
     }
 
     logs_dbg("Check success. Matched config name: %s\n", this->name.c_str());
+    result.reason = "MatchAll: all checks passed";
 
     return true;
 }
 
-bool Config::performCheckMatchAny()
+bool Config::performCheckMatchAny(dbus::Backend& backend,
+                                  ConfigResult& result) const
 {
     logs_dbg("Performing check Match Any\n");
-    for (platform_checks::Checks_t& check : this->checks)
+    result.checks.clear();
+    result.decisiveChecks.clear();
+    for (const platform_checks::Checks_t& check : this->checks)
     {
-        if (check.performChecks() == true)
+        auto& checkResult = result.checks.emplace_back();
+        if (check.performChecks(backend, checkResult) == true)
         {
             logs_dbg("Check match for %s\n", this->name.c_str());
+            result.decisiveChecks.push_back(check.describe());
+            result.reason = "MatchOne: " + check.describe() + " passed";
             return true;
         }
     }
 
     logs_dbg("Check did not match for: %s\n", this->name.c_str());
+    result.reason = "MatchOne: no check passed";
+
+    return false;
+}
+
+bool Config::matchRule(
+    const std::vector<platform_checks::CheckResult>& results) const
+{
+    auto rule = this->rule.empty() ? std::string{constants::MATCH_ALL}
+                                   : this->rule;
+    boost::algorithm::to_lower(rule);
 
+    auto passed = [](const platform_checks::CheckResult& result) {
+        return result.passed;
+    };
+    if (rule == constants::MATCH_ALL)
+    {
+        return std::all_of(results.begin(), results.end(), passed);
+    }
+    if (rule == constants::MATCH_ONE)
+    {
+        return std::any_of(results.begin(), results.end(), passed);
+    }
     return false;
 }
 
-int Config::performActions()
+int Config::performActions(const std::string& envFile) const
 {
     logs_dbg("Perform actions for %s\n", this->name.c_str());
     int rc = 0;
     bool fileCreated = false;
-    for (platform_actions::Actions_t& action : this->actions)
+    for (const platform_actions::Actions_t& action : this->actions)
     {
-        rc = action.performActions(this->name, fileCreated);
+        rc = action.performActions(this->name, fileCreated, envFile);
         if (rc != 0)
         {
+            pcm_metrics::actionsFailed.inc();
             return rc;
         }
     }
+    pcm_metrics::actionsApplied.inc();
     return rc;
 }
 
-bool Config::matchName(const std::string& name)
+int Config::exportEnvironment(
+    const std::vector<std::string>& previousNames) const
+{
+    trace_span("actions", "export", this->name);
+    logs_dbg("Export environment for %s to systemd manager\n",
+             this->name.c_str());
+
+    std::vector<std::string> assignments{
+        std::string(constants::PCM_MANAGER_NAME) + "=" + this->name};
+    for (const auto& action : this->actions)
+    {
+        assignments.insert(assignments.end(), action.variables.begin(),
+                           action.variables.end());
+    }
+
+    std::vector<std::string> unset;
+    for (auto previous : previousNames)
+    {
+        // NAME of the environment file was exported as PCM_NAME
+        if (previous == "NAME")
+        {
+            previous = constants::PCM_MANAGER_NAME;
+        }
+        auto stillSet = std::any_of(assignments.begin(), assignments.end(),
+                                    [&previous](const std::string& a) {
+            return a.compare(0, previous.size() + 1, previous + "=") == 0;
+        });
+        if (!stillSet)
+        {
+            logs_dbg("Unsetting stale variable: %s\n", previous.c_str());
+            unset.push_back(previous);
+        }
+    }
+
+    try
+    {
+        dbus::setManagerEnvironment(unset, assignments);
+    }
+    catch (const std::exception& e)
+    {
+        logs_err(
+            "Exception occurred while exporting environment to systemd manager. Exception: %s\n",
+            e.what());
+        return 1;
+    }
+
+    return 0;
+}
+
+bool Config::matchName(const std::string& name) const
 {
     logs_dbg("Match name from platform config %s and argument NAME=%s\n",
              this->name.c_str(), name.c_str());
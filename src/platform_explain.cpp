@@ -0,0 +1,185 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "platform_explain.hpp"
+
+#include "constants.hpp"
+#include "dbus_accessor.hpp"
+
+#include <fmt/format.h>
+
+#include <stdexcept>
+
+namespace platform_explain
+{
+
+namespace
+{
+
+/** Value read from the object at index i, empty when the read failed */
+std::string valueAt(const platform_checks::CheckResult& result, size_t i)
+{
+    return (i < result.values.size()) ? dbus::toString(result.values[i])
+                                      : std::string{};
+}
+
+std::string ruleOf(const std::string& rule)
+{
+    return rule.empty() ? std::string{constants::MATCH_ALL} : rule;
+}
+
+json checkToJson(const platform_checks::Checks_t& check,
+                 const platform_checks::CheckResult* result)
+{
+    json j;
+    j["check"] = check.describe();
+    j["rule"] = ruleOf(check.rule);
+    j["interface"] = check.interface;
+    j["property"] = check.property;
+    j["expected"] = check.value;
+    j["evaluated"] = (result != nullptr);
+    if (result == nullptr)
+    {
+        return j;
+    }
+
+    j["objects"] = json::array();
+    for (size_t i = 0; i < result->objects.size(); i++)
+    {
+        j["objects"].push_back(
+            {{"path", result->objects[i]}, {"value", valueAt(*result, i)}});
+    }
+    j["passed"] = result->passed;
+    j["reason"] = result->reason;
+    j["duration_us"] = result->duration;
+    return j;
+}
+
+json toJson(const platform_matcher::MatchResult& match)
+{
+    json j;
+    j["winner"] = match.winner ? match.winner->name : "";
+    j["default"] = match.isDefault;
+    j["duration_us"] = match.duration;
+    j["dbus_calls"] = match.dbusCallCount;
+    j["cache_hits"] = match.cacheHits;
+    j["configs"] = json::array();
+
+    for (const auto& result : match.configs)
+    {
+        json c;
+        c["name"] = result.name;
+        c["file"] = result.file;
+        c["evaluated"] = result.evaluated;
+        c["matched"] = result.matched;
+        c["reason"] = result.reason;
+        c["duration_us"] = result.duration;
+        c["decisive_checks"] = result.decisiveChecks;
+        c["checks"] = json::array();
+        if (result.config)
+        {
+            const auto& checks = result.config->checks;
+            c["rule"] = ruleOf(result.config->rule);
+            for (size_t i = 0; i < checks.size(); i++)
+            {
+                c["checks"].push_back(checkToJson(
+                    checks[i], (result.evaluated && i < result.checks.size())
+                                   ? &result.checks[i]
+                                   : nullptr));
+            }
+        }
+        j["configs"].push_back(std::move(c));
+    }
+    return j;
+}
+
+void appendTable(fmt::memory_buffer& out,
+                 const platform_matcher::MatchResult& match)
+{
+    auto appender = fmt::appender(out);
+    for (const auto& result : match.configs)
+    {
+        const char* outcome = !result.evaluated ? "SKIPPED"
+                              : result.matched  ? "MATCHED"
+                                                : "NO MATCH";
+        fmt::format_to(appender, "{} ({})\n  {:<9} {:>8} us  rule {}\n",
+                       result.name, result.file, outcome, result.duration,
+                       result.config ? ruleOf(result.config->rule) : "");
+        if (result.config)
+        {
+            const auto& checks = result.config->checks;
+            for (size_t i = 0; i < checks.size(); i++)
+            {
+                if (!result.evaluated || i >= result.checks.size())
+                {
+                    fmt::format_to(appender, "    [skip] {}\n",
+                                   checks[i].describe());
+                    continue;
+                }
+                const auto& check = result.checks[i];
+                fmt::format_to(appender, "    [{}] {} {:>8} us{}{}\n",
+                               check.passed ? "pass" : "FAIL",
+                               checks[i].describe(), check.duration,
+                               check.reason.empty() ? "" : "  ",
+                               check.reason);
+                for (size_t k = 0; k < check.objects.size(); k++)
+                {
+                    fmt::format_to(appender, "           {} = {}\n",
+                                   check.objects[k], valueAt(check, k));
+                }
+            }
+        }
+        fmt::format_to(appender, "  {}\n\n", result.reason);
+    }
+
+    fmt::format_to(appender,
+                   "Winner: {}{}, {} us, {} D-Bus calls, {} cache hits\n",
+                   match.winner ? match.winner->name : "none",
+                   match.isDefault ? " (default)" : "", match.duration,
+                   match.dbusCallCount, match.cacheHits);
+}
+
+} // namespace
+
+Format formatFromName(const std::string& name)
+{
+    if (name == "json")
+    {
+        return Format::json;
+    }
+    if (name == "table")
+    {
+        return Format::table;
+    }
+    throw std::invalid_argument("Unknown explain format " + name +
+                                ", expected json or table");
+}
+
+std::string explain(const platform_matcher::MatchResult& match,
+                    Format format)
+{
+    if (format == Format::json)
+    {
+        return toJson(match).dump(2) + "\n";
+    }
+
+    fmt::memory_buffer out;
+    appendTable(out, match);
+    return fmt::to_string(out);
+}
+
+} // namespace platform_explain
@@ -0,0 +1,257 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_CATEGORY config
+
+#include "platform_matcher.hpp"
+
+#include "constants.hpp"
+#include "log.hpp"
+#include "log_trace.hpp"
+#include "pcm_metrics.hpp"
+#include "pcm_report.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace platform_matcher
+{
+
+namespace
+{
+
+std::shared_ptr<const platform_config::Config>
+    loadConfig(const std::string& file)
+{
+    trace_span("config", "load", file);
+    pcm_report::Scope phase(pcm_report::Phase::load);
+    auto config = std::make_shared<platform_config::Config>();
+    try
+    {
+        if (!config->loadFromFile(file))
+        {
+            logs_err("Unable to access Platform Config file: %s\n",
+                     file.c_str());
+            return nullptr;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        logs_err("Exception occurred while loading Platform Config file %s: %s\n",
+                 file.c_str(), e.what());
+        return nullptr;
+    }
+    return config;
+}
+
+} // namespace
+
+std::vector<std::string> MatchResult::matches() const
+{
+    std::vector<std::string> names;
+    for (const auto& config : configs)
+    {
+        if (config.matched)
+        {
+            names.push_back(config.name);
+        }
+    }
+    return names;
+}
+
+PlatformMatcher::PlatformMatcher(const std::string& dataDir) :
+    confPath(dataDir + "platform-configuration-files/"),
+    defaultFile(dataDir + constants::DEFAULT_CONF_FILE_NAME)
+{
+    logs_dbg("Iterating over Platform Configuration files in directory: %s\n",
+             confPath.c_str());
+
+    std::vector<std::string> files;
+    try
+    {
+        pcm_report::Scope phase(pcm_report::Phase::scan);
+        for (auto& file : fs::directory_iterator(confPath))
+        {
+            files.push_back(file.path());
+        }
+    }
+    catch (const std::exception& e)
+    {
+        logs_err("Exception occurred while listing %s: %s\n",
+                 confPath.c_str(), e.what());
+    }
+    std::sort(files.begin(), files.end());
+
+    auto set = std::make_shared<ConfigSet>();
+    for (const auto& file : files)
+    {
+        logs_dbg("Iterating Platform Config file: %s\n", file.c_str());
+        if (auto config = loadConfig(file))
+        {
+            set->configs.push_back(std::move(config));
+        }
+    }
+
+    logs_dbg("Loading Default platform configuration file: %s\n",
+             defaultFile.c_str());
+    set->defaultConfig = loadConfig(defaultFile);
+
+    pcm_metrics::configFiles.set(set->configs.size());
+    configSet.store(std::move(set));
+}
+
+bool PlatformMatcher::reload(const std::vector<std::string>& files)
+{
+    std::lock_guard<std::mutex> guard(reloadMutex);
+
+    auto set = std::make_shared<ConfigSet>(*configSet.load());
+    bool changed = false;
+
+    for (const auto& file : files)
+    {
+        bool exists = fs::exists(file);
+        auto config = exists ? loadConfig(file) : nullptr;
+        if (exists && !config)
+        {
+            logs_err("Keeping previous version of %s\n", file.c_str());
+            continue;
+        }
+
+        if (file == defaultFile)
+        {
+            logs_dbg("Reloaded Default platform configuration file: %s\n",
+                     file.c_str());
+            set->defaultConfig = std::move(config);
+            changed = true;
+            continue;
+        }
+        if (fs::path(file).parent_path() != fs::path(confPath).parent_path())
+        {
+            continue;
+        }
+
+        auto it = std::find_if(set->configs.begin(), set->configs.end(),
+                               [&file](const auto& c) {
+            return c->file == file;
+        });
+        if (it != set->configs.end())
+        {
+            set->configs.erase(it);
+        }
+        if (config)
+        {
+            auto pos = std::find_if(set->configs.begin(), set->configs.end(),
+                                    [&file](const auto& c) {
+                return c->file > file;
+            });
+            set->configs.insert(pos, std::move(config));
+        }
+        logs_dbg("Reloaded Platform Config file: %s\n", file.c_str());
+        changed = true;
+    }
+
+    if (changed)
+    {
+        pcm_metrics::configFiles.set(set->configs.size());
+        configSet.store(std::move(set));
+    }
+    return changed;
+}
+
+MatchResult PlatformMatcher::evaluate(dbus::Backend& backend,
+                                      bool stopAtFirstMatch) const
+{
+    trace_span("config", "evaluate");
+    pcm_report::Scope phase(pcm_report::Phase::match);
+    auto begin = std::chrono::steady_clock::now();
+    auto set = configSet.load();
+    dbus::CachedBackend cache(backend);
+    MatchResult result;
+
+    result.configs.reserve(set->configs.size());
+    for (const auto& config : set->configs)
+    {
+        auto& configResult = result.configs.emplace_back();
+        configResult.config = config;
+        if (result.winner && stopAtFirstMatch)
+        {
+            configResult.name = config->name;
+            configResult.file = config->file;
+            configResult.reason = "Not evaluated: " + result.winner->name +
+                                  " matched first";
+            continue;
+        }
+
+        if (config->performChecks(cache, configResult) && !result.winner)
+        {
+            result.winner = config;
+        }
+    }
+
+    if (!result.winner)
+    {
+        logs_dbg("No platform configuration matched, using the default.\n");
+        result.winner = set->defaultConfig;
+        result.isDefault = true;
+    }
+
+    result.dbusCallCount = cache.getMisses();
+    result.cacheHits = cache.getHits();
+    result.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - begin)
+                          .count();
+
+    pcm_metrics::evaluations.inc();
+    pcm_metrics::detectionLatency.observe(result.duration);
+    pcm_metrics::cacheHits.inc(result.cacheHits);
+    pcm_metrics::cacheMisses.inc(result.dbusCallCount);
+    if (result.isDefault)
+    {
+        pcm_metrics::defaultConfigUsed.inc();
+    }
+    return result;
+}
+
+std::shared_ptr<const platform_config::Config>
+    PlatformMatcher::findByName(const std::string& name) const
+{
+    auto set = configSet.load();
+    for (const auto& config : set->configs)
+    {
+        if (config->matchName(name))
+        {
+            return config;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const platform_config::Config>
+    PlatformMatcher::getDefaultConfig() const
+{
+    return configSet.load()->defaultConfig;
+}
+
+std::shared_ptr<const ConfigSet> PlatformMatcher::getConfigSet() const
+{
+    return configSet.load();
+}
+
+} // namespace platform_matcher
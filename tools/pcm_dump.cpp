@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * pcm-dump - print the messages kept in the flight recorder of pcmd
+ *
+ *   pcm-dump [<count>]
+ *
+ * Prints the last count messages, all of them by default, oldest first.
+ * Works while pcmd runs and after it exited or crashed.
+ */
+
+#include "log.hpp"
+#include "log_flight.hpp"
+
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    size_t last = 0;
+    if (argc > 1)
+    {
+        try
+        {
+            last = std::stoul(argv[1]);
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "usage: " << argv[0] << " [<count>]\n";
+            return 2;
+        }
+    }
+
+    auto block = logging::flight::openBlock();
+    if (block == nullptr)
+    {
+        std::cerr << "No flight recorder found in /dev/shm/"
+                  << logging::flight::SHM_NAME << "\n";
+        return 1;
+    }
+
+    fmt::memory_buffer out;
+    auto count = logging::flight::dump(*block, out, last);
+    std::cout.write(out.data(), out.size());
+    std::cerr << count << " messages, last written by pid " << block->pid
+              << "\n";
+    logging::flight::closeBlock(block);
+    return 0;
+}
@@ -0,0 +1,304 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * pcm-eval - evaluate platform configurations against captured inventories
+ *
+ *   pcm-eval [-j <threads>] <data-dir> <capture-dir>
+ *
+ * Loads the platform configurations of data-dir once, as pcmd does, and
+ * evaluates every capture of capture-dir (see pcmd --capture) against all
+ * of them on a work-stealing thread pool. The match matrix is printed as
+ * CSV, one row per capture and one column per configuration. Captures which
+ * match no configuration, or more than one, are listed on stderr and make
+ * the exit status 2.
+ */
+
+#include "dbus_capture.hpp"
+#include "pcm_report.hpp"
+#include "platform_matcher.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+struct Outcome
+{
+    /** Matched configurations, in evaluation order */
+    std::vector<bool> matches;
+    size_t matchCount = 0;
+    std::string error;
+};
+
+/**
+ * Fixed set of jobs run by a pool of workers. Each worker takes jobs from
+ * the back of its own queue and, once it is empty, steals from the front of
+ * the others, so slow captures do not leave cores idle.
+ */
+class WorkStealingPool
+{
+  public:
+    WorkStealingPool(size_t jobCount, size_t workerCount) :
+        queues(workerCount)
+    {
+        for (size_t job = 0; job < jobCount; job++)
+        {
+            queues[job % workerCount].jobs.push_back(job);
+        }
+    }
+
+    template <typename Job>
+    void run(Job&& job)
+    {
+        std::vector<std::thread> workers;
+        for (size_t self = 0; self < queues.size(); self++)
+        {
+            workers.emplace_back([this, self, &job]() {
+                size_t next;
+                while (take(self, next))
+                {
+                    job(next);
+                }
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+  private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    bool take(size_t self, size_t& job)
+    {
+        {
+            auto& own = queues[self];
+            std::lock_guard<std::mutex> guard(own.mutex);
+            if (!own.jobs.empty())
+            {
+                job = own.jobs.back();
+                own.jobs.pop_back();
+                return true;
+            }
+        }
+        // No job is ever added, an empty pass means the work is done
+        for (size_t i = 1; i < queues.size(); i++)
+        {
+            auto& victim = queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.mutex);
+            if (!victim.jobs.empty())
+            {
+                job = victim.jobs.front();
+                victim.jobs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<Queue> queues;
+};
+
+std::string csvField(const std::string& str)
+{
+    if (str.find_first_of(",\"\n") == std::string::npos)
+    {
+        return str;
+    }
+    std::string quoted{"\""};
+    for (char c : str)
+    {
+        quoted += c;
+        if (c == '"')
+        {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+int usage(const char* name)
+{
+    std::cerr << "usage: " << name
+              << " [-j <threads>] <data-dir> <capture-dir>\n";
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    int opt;
+    while ((opt = getopt(argc, argv, "j:")) != -1)
+    {
+        if (opt != 'j')
+        {
+            return usage(argv[0]);
+        }
+        try
+        {
+            threads = std::max(1ul, std::stoul(optarg));
+        }
+        catch (const std::exception&)
+        {
+            return usage(argv[0]);
+        }
+    }
+    if (argc - optind != 2)
+    {
+        return usage(argv[0]);
+    }
+    std::string dataDir{argv[optind]};
+    if (dataDir.back() != '/')
+    {
+        dataDir += '/';
+    }
+
+    // Phase accounting is for pcmd, it would only cost syscalls here
+    pcm_report::setEnabled(false);
+
+    std::vector<std::string> captures;
+    try
+    {
+        for (const auto& entry : fs::directory_iterator(argv[optind + 1]))
+        {
+            if (entry.is_regular_file())
+            {
+                captures.push_back(entry.path());
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    std::sort(captures.begin(), captures.end());
+
+    // Compiled once, shared read-only by all the workers
+    platform_matcher::PlatformMatcher matcher(dataDir);
+    auto set = matcher.getConfigSet();
+    if (set->configs.empty())
+    {
+        std::cerr << "No platform configuration in " << dataDir << "\n";
+        return 1;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<Outcome> outcomes(captures.size());
+    threads = std::min(threads, std::max<size_t>(1, captures.size()));
+    WorkStealingPool pool(captures.size(), threads);
+    pool.run([&](size_t i) {
+        auto& outcome = outcomes[i];
+        try
+        {
+            dbus::ReplayBackend backend(captures[i], dbus::ReplayTiming::fast);
+            auto match = matcher.evaluate(backend, false);
+            for (const auto& config : match.configs)
+            {
+                outcome.matches.push_back(config.matched);
+                outcome.matchCount += config.matched;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            outcome.error = e.what();
+        }
+    });
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+
+    std::cout << "capture";
+    for (const auto& config : set->configs)
+    {
+        std::cout << "," << csvField(config->name);
+    }
+    std::cout << "\n";
+    std::vector<size_t> perConfig(set->configs.size());
+    size_t ambiguous = 0;
+    size_t unmatched = 0;
+    for (size_t i = 0; i < captures.size(); i++)
+    {
+        const auto& outcome = outcomes[i];
+        std::cout << csvField(fs::path(captures[i]).filename());
+        for (size_t c = 0; c < set->configs.size(); c++)
+        {
+            bool matched = c < outcome.matches.size() && outcome.matches[c];
+            perConfig[c] += matched;
+            std::cout << (matched ? ",1" : ",0");
+        }
+        std::cout << "\n";
+
+        if (!outcome.error.empty())
+        {
+            std::cerr << "error: " << captures[i] << ": " << outcome.error
+                      << "\n";
+            unmatched++;
+        }
+        else if (outcome.matchCount == 0)
+        {
+            std::cerr << "no match: " << captures[i] << "\n";
+            unmatched++;
+        }
+        else if (outcome.matchCount > 1)
+        {
+            std::cerr << "multiple matches: " << captures[i] << ":";
+            for (size_t c = 0; c < outcome.matches.size(); c++)
+            {
+                if (outcome.matches[c])
+                {
+                    std::cerr << " " << set->configs[c]->name;
+                }
+            }
+            std::cerr << "\n";
+            ambiguous++;
+        }
+    }
+
+    for (size_t c = 0; c < set->configs.size(); c++)
+    {
+        std::cerr << set->configs[c]->name << ": " << perConfig[c]
+                  << " captures\n";
+    }
+    std::cerr << captures.size() << " captures evaluated in " << elapsed
+              << " ms on " << threads << " threads, " << unmatched
+              << " without a match, " << ambiguous
+              << " with multiple matches\n";
+
+    return (unmatched || ambiguous) ? 2 : 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * pcm-logctl - list and change the log levels of a running pcmd
+ *
+ *   pcm-logctl                      list the level of every category
+ *   pcm-logctl <category> <level>   set the level of one category
+ *   pcm-logctl all <level>          set the level of every category
+ *
+ * Levels are 0 (disabled) to 4 (information), see log.hpp.
+ */
+
+#include "log.hpp"
+#include "log_ctrl.hpp"
+
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+constexpr std::string_view levelNames[] = {"disabled", "error", "warning",
+                                           "debug", "information"};
+
+void list(const logging::ctrl::Block& block)
+{
+    for (size_t i = 0; i < logging::ctrl::categoryNames.size(); i++)
+    {
+        auto level = block.levels[i].load(std::memory_order_relaxed);
+        std::cout << logging::ctrl::categoryNames[i] << " " << level;
+        if (level >= 0 && level < static_cast<int>(std::size(levelNames)))
+        {
+            std::cout << " (" << levelNames[level] << ")";
+        }
+        std::cout << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 1 && argc != 3)
+    {
+        std::cerr << "usage: " << argv[0] << " [<category|all> <level>]\n";
+        return 2;
+    }
+
+    auto block = logging::ctrl::openBlock(DBG_LOG_CTRL);
+    if (block == nullptr)
+    {
+        std::cerr << "No log control block found in /dev/shm/" << DBG_LOG_CTRL
+                  << "\n";
+        return 1;
+    }
+
+    int rc = 0;
+    if (argc == 1)
+    {
+        list(*block);
+    }
+    else
+    {
+        int level = -1;
+        try
+        {
+            level = std::stoi(argv[2]);
+        }
+        catch (const std::exception&)
+        {}
+        std::string_view name(argv[1]);
+        auto category = logging::ctrl::categoryFromName(name);
+        if (level < 0 || level > LogLevel::information)
+        {
+            std::cerr << "Level out of range [0-4]: " << argv[2] << "\n";
+            rc = 2;
+        }
+        else if (name == "all")
+        {
+            for (size_t i = 0; i < logging::ctrl::categoryNames.size(); i++)
+            {
+                block->levels[i].store(level, std::memory_order_relaxed);
+            }
+        }
+        else if (category)
+        {
+            block->levels[static_cast<size_t>(*category)].store(
+                level, std::memory_order_relaxed);
+        }
+        else
+        {
+            std::cerr << "Unknown category: " << name << "\n";
+            rc = 2;
+        }
+    }
+
+    logging::ctrl::closeBlock(block);
+    return rc;
+}
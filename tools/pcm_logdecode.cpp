@@ -0,0 +1,150 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * pcm-logdecode - turn binary log files written by pcmd -b back into text
+ *
+ *   pcm-logdecode <file> [<file>...]
+ *
+ * Files are decoded in the given order, so rotated files can be passed
+ * oldest first. The output matches the text log format.
+ */
+
+#include "log.hpp"
+#include "log_binary.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+struct Site
+{
+    std::string file;
+    uint32_t line;
+    std::string func;
+    std::string format;
+};
+
+std::map<uint32_t, Site> sites;
+
+void decodeMessage(logging::binary::Reader& reader, fmt::memory_buffer& out)
+{
+    logging::binary::Message message;
+    logging::binary::readMessage(reader, message);
+
+    auto site = sites.find(message.id);
+    if (site == sites.end())
+    {
+        Log::appendHeader(out, message.flags & logging::binary::levelMask,
+                          message.ts, message.steady);
+        fmt::format_to(fmt::appender(out), "[unknown site {:08x}]\n",
+                       message.id);
+        return;
+    }
+    Log::appendMessage(out, message, site->second.file, site->second.line,
+                       site->second.func, site->second.format);
+}
+
+int decodeFile(const std::string& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open())
+    {
+        std::cerr << file << ": cannot open\n";
+        return 1;
+    }
+    std::string data{std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>()};
+
+    logging::binary::Reader reader(data);
+    if (!reader.skipMagic())
+    {
+        std::cerr << file << ": not a binary pcm log\n";
+        return 1;
+    }
+
+    fmt::memory_buffer out;
+    try
+    {
+        while (!reader.atEnd())
+        {
+            if (reader.skipMagic())
+            {
+                continue;
+            }
+            switch (static_cast<logging::binary::Record>(
+                reader.get<uint8_t>()))
+            {
+                case logging::binary::Record::site:
+                {
+                    auto id = reader.get<uint32_t>();
+                    Site& site = sites[id];
+                    site.line = reader.getVarint();
+                    site.file = reader.getString();
+                    site.func = reader.getString();
+                    site.format = reader.getString();
+                    break;
+                }
+                case logging::binary::Record::message:
+                    decodeMessage(reader, out);
+                    break;
+                default:
+                    throw std::runtime_error("unknown record type");
+            }
+
+            if (out.size() > 65536)
+            {
+                std::cout.write(out.data(), out.size());
+                out.clear();
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cout.write(out.data(), out.size());
+        std::cerr << file << ": " << e.what() << " at offset "
+                  << reader.offset() << "\n";
+        return 1;
+    }
+
+    std::cout.write(out.data(), out.size());
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <file> [<file>...]\n";
+        return 2;
+    }
+
+    int rc = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        rc |= decodeFile(argv[i]);
+    }
+    return rc;
+}